@@ -1,125 +1,209 @@
-#include "stm8s.h"
-#include "HD44780.h"
-#include "delay.h"
-#include <assert.h>
-
-static struct
-{
-	GPIO_TypeDef*    port;
-	GPIO_Pin_TypeDef rs;
-	GPIO_Pin_TypeDef e;
-	GPIO_Pin_TypeDef data;
-} gLcd;
-
-void WriteLowNibble(unsigned char cmd)
-{
-	unsigned char oldV = GPIO_ReadOutputData(gLcd.port);
-
-	GPIO_Write(gLcd.port, (oldV & 0xF0) | (cmd & 0x0F));
-	GPIO_WriteHigh(gLcd.port,gLcd.e);
-	delay(MS(1));
-	GPIO_WriteLow(gLcd.port,gLcd.e);
-}
-
-void WriteHighNibble(unsigned char cmd)
-{
-	unsigned char oldV = GPIO_ReadOutputData(gLcd.port);
-
-	GPIO_Write(gLcd.port, (oldV & 0x0F) | ((cmd << 4) & 0xF0));
-	GPIO_WriteHigh(gLcd.port,gLcd.e);
-	delay(MS(1));
-	GPIO_WriteLow(gLcd.port,gLcd.e);
-}
-
-void SendByte(unsigned char cmd)
-{
-	if (gLcd.data == GPIO_PIN_LNIB)
-	{
-		WriteLowNibble(cmd >> 4);
-		WriteLowNibble(cmd);
-	}
-	else
-	{
-		WriteHighNibble(cmd >> 4);
-		WriteHighNibble(cmd);
-	}
-}
-
-void SendCommand(unsigned char cmd)
-{
-	GPIO_WriteLow(gLcd.port,gLcd.rs);
-
-	SendByte(cmd);
-	
-	delay(MS(1));//US(60));
-}
-
-void SendData(unsigned char cmd)
-{
-	GPIO_WriteHigh(gLcd.port,gLcd.rs);
-
-	SendByte(cmd);
-	
-	delay(MS(1));//US(60));
-}
-
-void ClearLcd(int dummy)
-{
-	SendCommand(0x1);
-}
-
-void SetLine(int line)
-{
-	if (line)
-	{//1
-		SendCommand(0xC0);
-	}
-	else
-	{
-		SendCommand(0x80);
-	}
-}
-
-void Outline(int line, char *str)
-{
-	SetLine(line);
-	
-	while(*str)
-	{
-		SendData(*str++);
-	}
-}
-
-void Out(char *str)
-{
-	while(*str)
-	{
-		SendData(*str++);
-	}
-}
-
-void InitLcd(GPIO_TypeDef* port, GPIO_Pin_TypeDef rs, 
-					   GPIO_Pin_TypeDef e, GPIO_Pin_TypeDef data)
-{
-	//assert((data == GPIO_PIN_LNIB) || (data == GPIO_PIN_HNIB));
-	
-	gLcd.port = port;
-	gLcd.rs = rs;
-	gLcd.e = e;
-	gLcd.data = data;
-
-	GPIO_DeInit(gLcd.port);
-	GPIO_Init(gLcd.port, data | rs | e, GPIO_MODE_OUT_PP_LOW_FAST);
-	GPIO_WriteLow(gLcd.port, gLcd.e); //  
-	GPIO_WriteLow(gLcd.port, gLcd.rs);// 
-
-	delay(MS(10));    //,   
-	SendCommand(0x33);//
-	SendCommand(0x2); //  0
-	SendCommand(0x2C); //4 , 2 , 5*10 
-	SendCommand(0x1); // 
-	SendCommand(0x6); // 
-	SendCommand(0x8 | 0x4);
-}
-
-
+#include "stm8s.h"
+#include "HD44780.h"
+#include "delay.h"
+#include <assert.h>
+
+static struct
+{
+	GPIO_TypeDef*    port;
+	GPIO_Pin_TypeDef rs;
+	GPIO_Pin_TypeDef e;
+	GPIO_Pin_TypeDef data;
+} gLcd;
+
+void WriteLowNibble(unsigned char cmd)
+{
+	unsigned char oldV = GPIO_ReadOutputData(gLcd.port);
+
+	GPIO_Write(gLcd.port, (oldV & 0xF0) | (cmd & 0x0F));
+	GPIO_WriteHigh(gLcd.port,gLcd.e);
+	delay(MS(1));
+	GPIO_WriteLow(gLcd.port,gLcd.e);
+}
+
+void WriteHighNibble(unsigned char cmd)
+{
+	unsigned char oldV = GPIO_ReadOutputData(gLcd.port);
+
+	GPIO_Write(gLcd.port, (oldV & 0x0F) | ((cmd << 4) & 0xF0));
+	GPIO_WriteHigh(gLcd.port,gLcd.e);
+	delay(MS(1));
+	GPIO_WriteLow(gLcd.port,gLcd.e);
+}
+
+void SendByte(unsigned char cmd)
+{
+	if (gLcd.data == GPIO_PIN_LNIB)
+	{
+		WriteLowNibble(cmd >> 4);
+		WriteLowNibble(cmd);
+	}
+	else
+	{
+		WriteHighNibble(cmd >> 4);
+		WriteHighNibble(cmd);
+	}
+}
+
+void SendCommand(unsigned char cmd)
+{
+	GPIO_WriteLow(gLcd.port,gLcd.rs);
+
+	SendByte(cmd);
+	
+	delay(MS(1));//US(60));
+}
+
+void SendData(unsigned char cmd)
+{
+	GPIO_WriteHigh(gLcd.port,gLcd.rs);
+
+	SendByte(cmd);
+	
+	delay(MS(1));//US(60));
+}
+
+void ClearLcd(int dummy)
+{
+	SendCommand(0x1);
+}
+
+void SetLine(int line)
+{
+	if (line)
+	{//1
+		SendCommand(0xC0);
+	}
+	else
+	{
+		SendCommand(0x80);
+	}
+}
+
+//shows page 0 (columns 0..15) or page 1 (columns LCD_PAGE..) by display shift
+void ShowPage(int page)
+{
+	uint8_t i;
+	
+	SendCommand(0x2);//return home, shift reset
+	
+	if (page)
+	{
+		for (i = 0; i < LCD_PAGE; i++)
+		{
+			SendCommand(0x18);//shift display left
+		}
+	}
+}
+
+void Outline(int line, char *str)
+{
+	SetLine(line);
+	
+	while(*str)
+	{
+		SendData(*str++);
+	}
+}
+
+void Out(char *str)
+{
+	while(*str)
+	{
+		SendData(*str++);
+	}
+}
+
+static const unsigned char gInitSeq[] =
+{
+	0x33,		//8 bit twice, then
+	0x2,		//4 bit, cursor home
+	0x2C,		//4 bit, 2 lines, 5*10 font
+	0x1,		//clear
+	0x6,		//cursor moves right
+	0x8 | 0x4	//display on
+};
+
+static struct
+{
+	const char *str;	//banner, written after the init sequence
+	uint8_t step;	//next command of gInitSeq
+	uint8_t powerup;	//ms still to wait before the first command
+} gInit;
+
+/*
+Starts the power-up sequence without waiting: only the pins are set.
+The commands are sent by LcdStep, one per call, so they can run in waits
+of the measurement; banner (may be 0) follows on line 0.
+*/
+void StartLcd(GPIO_TypeDef* port, GPIO_Pin_TypeDef rs, 
+					   GPIO_Pin_TypeDef e, GPIO_Pin_TypeDef data, const char *banner)
+{
+	//assert((data == GPIO_PIN_LNIB) || (data == GPIO_PIN_HNIB));
+	
+	gLcd.port = port;
+	gLcd.rs = rs;
+	gLcd.e = e;
+	gLcd.data = data;
+
+	GPIO_DeInit(gLcd.port);
+	GPIO_Init(gLcd.port, data | rs | e, GPIO_MODE_OUT_PP_LOW_FAST);
+	GPIO_WriteLow(gLcd.port, gLcd.e);
+	GPIO_WriteLow(gLcd.port, gLcd.rs);
+
+	gInit.str = banner;
+	gInit.step = 0;
+	gInit.powerup = LCD_POWERUP_MS;
+}
+
+//ms passed since StartLcd outside of LcdStep; time not reported only makes the wait longer
+void LcdElapsed(uint8_t ms)
+{
+	gInit.powerup = (gInit.powerup > ms) ? (gInit.powerup - ms) : 0;
+}
+
+/*
+Next step of the background init, takes LCD_STEP_MS.
+Returns 0 if nothing was sent: all done or the power-up time is not over.
+*/
+uint8_t LcdStep(void)
+{
+	if (gInit.powerup)
+	{
+		return 0;
+	}
+
+	if (gInit.step < sizeof(gInitSeq))
+	{
+		SendCommand(gInitSeq[gInit.step++]);
+		return 1;
+	}
+
+	if (gInit.str && *gInit.str)
+	{
+		SendData(*gInit.str++);
+		return 1;
+	}
+
+	return 0;
+}
+
+//completes the init sequence, the LCD can be used afterwards
+void FinishLcd(void)
+{
+	while (gInit.powerup)
+	{
+		delay(MS(1));
+		gInit.powerup--;
+	}
+
+	while (LcdStep())
+		;
+}
+
+void InitLcd(GPIO_TypeDef* port, GPIO_Pin_TypeDef rs, 
+					   GPIO_Pin_TypeDef e, GPIO_Pin_TypeDef data)
+{
+	StartLcd(port, rs, e, data, 0);
+	FinishLcd();
+}
@@ -1,21 +1,38 @@
-#ifndef __HD44780_H__
-#define __HD44780_H__
-
-void InitLcd(GPIO_TypeDef* port, GPIO_Pin_TypeDef rs, 
-					   GPIO_Pin_TypeDef e, GPIO_Pin_TypeDef data);
-
-void ClearLcd(int dummy);//dummy needs for Cosmic - WTF?
-
-void Outline(int line, char *str);
-
-void SetLine(int line);
-
-void Out(char *str);
-
-void SendData(unsigned char cmd);
-
-void SendCommand(unsigned char cmd);
-
-#define SetCursor(y, x) SendCommand((uint8_t)(0x80 + (0x40*(y-1)) + x))
-
-#endif
+#ifndef __HD44780_H__
+#define __HD44780_H__
+
+void InitLcd(GPIO_TypeDef* port, GPIO_Pin_TypeDef rs, 
+					   GPIO_Pin_TypeDef e, GPIO_Pin_TypeDef data);
+
+#define LCD_POWERUP_MS 10	//wait after power up before the first command
+#define LCD_STEP_MS 3		//one command or character (two nibbles and the execution time)
+
+void StartLcd(GPIO_TypeDef* port, GPIO_Pin_TypeDef rs, 
+					   GPIO_Pin_TypeDef e, GPIO_Pin_TypeDef data, const char *banner);
+
+void LcdElapsed(uint8_t ms);
+
+uint8_t LcdStep(void);
+
+void FinishLcd(void);
+
+void ClearLcd(int dummy);//dummy needs for Cosmic - WTF?
+
+void Outline(int line, char *str);
+
+void SetLine(int line);
+
+void Out(char *str);
+
+void SendData(unsigned char cmd);
+
+void SendCommand(unsigned char cmd);
+
+#define SetCursor(y, x) SendCommand((uint8_t)(0x80 + (0x40*(y-1)) + x))
+
+//second display page starts at this DDRAM column (40 columns per line)
+#define LCD_PAGE 20
+
+void ShowPage(int page);
+
+#endif
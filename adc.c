@@ -0,0 +1,538 @@
+#include "stm8s.h"
+#include "stm8s_adc1.h"
+#include "delay.h"
+#include "adc.h"
+#include "trace.h"
+#include "watchdog.h"
+
+#define TIM1_MMS_UPDATE 0x20	//TRGO on update event, CR2 MMS = 010
+
+static struct
+{
+	uint8_t cr1;
+	uint8_t ddr;
+} gPin;
+
+uint8_t ADCTimeout;
+
+/*
+Bounded wait for EOC. A single conversion takes at most 126 us, a scan or a
+buffer fill about 1 ms; EOC_TIMEOUT polls are several times that. A missing EOC
+sets ADCTimeout, the caller gets a wrong value and TestPart rejects the step.
+*/
+static void WaitEOC(void)
+{
+	uint16_t n = EOC_TIMEOUT;
+
+	while(!ADC1_GetFlagStatus(ADC1_FLAG_EOC))
+	{
+		if (--n == 0)
+		{
+			ADCTimeout = 1;
+			return;
+		}
+	}
+}
+
+//switches the testpoint to analog input and the ADC to its channel
+static void OpenADC(uint8_t tp, ADC1_PresSel_TypeDef pres, ADC1_ConvMode_TypeDef mode)
+{
+	gPin.cr1 = GPIOB->CR1;
+	gPin.ddr = GPIOB->DDR;
+
+	GPIOB->DDR &= (uint8_t)(~(1 << tp));
+	GPIOB->CR1 &= (uint8_t)(~(1 << tp));
+	GPIOB->CR2 &= (uint8_t)(~(1 << tp));
+
+	ADC1_DeInit();
+	ADC1_Init(mode, tp, pres,
+	ADC1_EXTTRIG_TIM, DISABLE, ADC1_ALIGN_RIGHT, tp, DISABLE);
+}
+
+static void CloseADC(void)
+{
+	ADC1_DeInit();
+
+	GPIOB->DDR = gPin.ddr;
+	GPIOB->CR1 = gPin.cr1;
+}
+
+//one single conversion; EOC must be cleared by software, else the next one is not waited for
+static uint16_t Convert(void)
+{
+	uint16_t value;
+
+	ADC1_StartConversion();
+	WaitEOC();
+	value = ADC1_GetConversionValue(); // read ADC conversion data, the first low, then high
+	ADC1_ClearFlag(ADC1_FLAG_EOC);
+
+	return value;
+}
+
+static uint16_t Sqrt(uint32_t v)
+{
+	uint16_t res = 0;
+	uint16_t bit = 0x400;	//variance of 10 bit values is below 2^20
+
+	while (bit)
+	{
+		if ((uint32_t)(res | bit) * (res | bit) <= v)
+		{
+			res |= bit;
+		}
+		bit >>= 1;
+	}
+
+	return res;
+}
+
+/*
+Sampling core. Sum and sum of squares give mean and variance:
+V = n * sum(x^2) - sum(x)^2 = n * (n-1) * s^2
+Sequential mode stops as soon as the 3-sigma interval of the mean lies more than
+Margin away from Level, i.e. with D = n * (|mean - Level| - Margin):
+D^2 > 9 * n * s^2 = 9 * V / (n-1)
+s is at least 1 LSB (quantization), so clean readings far from the level
+need ADC_SEQ_MIN conversions; borderline readings take all ADC_SAMPLES.
+*/
+static uint16_t Sample(uint8_t tp, uint16_t Level, uint8_t Margin, uint8_t Seq, ADCStat *stat)
+{
+	uint8_t n = 0;
+	uint16_t sum = 0;
+	uint32_t sq = 0;
+	uint32_t var;
+	uint16_t value;
+	int32_t d;
+
+	OpenADC(tp, ADC1_PRESSEL_FCPU_D12, ADC1_CONVERSIONMODE_SINGLE);
+
+	do
+	{
+		value = Convert();
+		n++;
+		sum += value;
+		sq += (uint32_t)value * value;
+
+		if (Seq && (n >= ADC_SEQ_MIN))
+		{
+			var = n * sq - (uint32_t)sum * sum;
+			if (var < (uint32_t)n * (n - 1))
+			{
+				var = (uint32_t)n * (n - 1);
+			}
+			d = (int32_t)sum - (int32_t)n * Level;
+			if (d < 0)
+			{
+				d = -d;
+			}
+			d -= (int32_t)n * Margin;
+			if ((d > 0) && ((uint32_t)d * (uint32_t)d * (n - 1) > 9 * var))
+			{
+				break;
+			}
+		}
+	} while (n < ADC_SAMPLES);
+
+	CloseADC();
+	TraceADC(tp, sum / n);
+
+	if (stat)
+	{
+		stat->Mean = sum / n;
+		stat->Count = n;
+		stat->Spread = Sqrt((n * sq - (uint32_t)sum * sum) / ((uint32_t)n * (n - 1)));
+	}
+
+	return (sum / n);
+}
+
+//mean of ADC_SAMPLES conversions
+uint16_t ReadADC(uint8_t tp)
+{
+	return Sample(tp, 0, 0, 0, 0);
+}
+
+//mean of ADC_SAMPLES conversions, mean and spread are also stored in stat
+uint16_t ReadADCStat(uint8_t tp, ADCStat *stat)
+{
+	return Sample(tp, 0, 0, 0, stat);
+}
+
+//coarse reading for decisions with wide margins: mean of ADC_SEQ_MIN conversions, about 0.2 ms
+uint16_t ReadADCCoarse(uint8_t tp)
+{
+	uint8_t n;
+	uint16_t sum = 0;
+
+	OpenADC(tp, ADC1_PRESSEL_FCPU_D12, ADC1_CONVERSIONMODE_SINGLE);
+	for (n = 0; n < ADC_SEQ_MIN; n++)
+	{
+		sum += Convert();
+	}
+	CloseADC();
+	sum /= ADC_SEQ_MIN;
+	TraceADC(tp, sum);
+
+	return sum;
+}
+
+/*
+Threshold decision with sequential sampling: is the voltage above Level?
+Sampling stops once the confidence interval of the mean is clear of Level by Margin.
+stat (may be 0) receives mean, spread and the number of conversions.
+*/
+uint8_t ReadADCAbove(uint8_t tp, uint16_t Level, uint8_t Margin, ADCStat *stat)
+{
+	return (Sample(tp, Level, Margin, 1, stat) > Level);
+}
+
+/*
+Hum synchronous sampling. On the R_H nodes the bench couples 50/60 Hz into the
+reading; a burst of conversions catches one phase of it. TIM1 triggers the ADC
+count times per mains period (TRGO on update, no CPU timing), so the mean covers
+exactly one period and the hum and its harmonics up to count/2 - 1 cancel out.
+The interval is 1.25 ms for HUM_SAMPLES at 50 Hz, 0.3 ms for LEAK_SAMPLES.
+*/
+static void StartHum(uint8_t count)
+{
+	uint16_t arr = (uint16_t)((F_CPU + MAINS_HZ * count / 2) / ((uint32_t)MAINS_HZ * count)) - 1;
+
+	TIM1->CR1 = 0;
+	TIM1->PSCRH = 0;
+	TIM1->PSCRL = 0;
+	TIM1->ARRH = (uint8_t)(arr >> 8);
+	TIM1->ARRL = (uint8_t)arr;
+	TIM1->EGR = TIM1_EGR_UG;	//load prescaler and ARR before TRGO is connected
+	TIM1->CR2 = TIM1_MMS_UPDATE;
+	ADC1_ExternalTriggerConfig(ADC1_EXTTRIG_TIM, ENABLE);
+	TIM1->CR1 = TIM1_CR1_CEN;
+}
+
+static void StopHum(void)
+{
+	TIM1->CR1 = 0;
+	TIM1->CR2 = 0;
+}
+
+/*
+Long integration for leakage currents over R_H:
+LEAK_SAMPLES conversions spread over one mains period (20 ms at 50 Hz).
+Returns the mean value * 16 (4 additional bits from oversampling).
+*/
+uint16_t ReadADCLong(uint8_t tp)
+{
+	uint8_t i;
+	uint32_t value = 0;
+
+	OpenADC(tp, ADC1_PRESSEL_FCPU_D12, ADC1_CONVERSIONMODE_SINGLE);
+	StartHum(LEAK_SAMPLES);
+
+	for(i = 0; i < LEAK_SAMPLES; i++)
+	{
+		WaitEOC();	//the conversion is started by TIM1
+		value += ADC1_GetConversionValue();
+		ADC1_ClearFlag(ADC1_FLAG_EOC);
+	}
+
+	StopHum();
+	CloseADC();
+
+	value = (value * 16) / LEAK_SAMPLES;
+	TraceADC(tp, (uint16_t)value);
+
+	return (uint16_t)value;
+}
+
+//converts tp until the voltage passes Level, count is decremented per conversion
+static uint16_t Edge(uint8_t tp, uint16_t Level, uint8_t Rising, uint16_t *count, ADC1_PresSel_TypeDef pres)
+{
+	uint16_t value;
+
+	OpenADC(tp, pres, ADC1_CONVERSIONMODE_SINGLE);
+
+	do
+	{
+		value = Convert();
+		if(Rising) {
+			if(value > Level) break;
+		} else {
+			if(value < Level) break;
+		}
+	} while(--*count);
+
+	CloseADC();
+	TraceADC(tp, value);
+
+	return value;
+}
+
+/*
+Edge detection with fast single conversions (fADC = fCPU/2, about 20 us per loop):
+converts tp until the voltage is above (Rising) or below (!Rising) Level,
+at most MaxCount times. Returns the last value, the caller checks it again.
+Switching transitions end the wait at once; "must stay" checks use LATCH_WINDOW.
+Only for low impedance nodes (R_L or firmly driven), the sample time is too short for R_H.
+*/
+uint16_t WaitADC(uint8_t tp, uint16_t Level, uint8_t Rising, uint16_t MaxCount)
+{
+	return Edge(tp, Level, Rising, &MaxCount, ADC1_PRESSEL_FCPU_D2);
+}
+
+/*
+Rise time on a node charged over R_H: number of conversions (RISE_US each,
+fADC = fCPU/18 for the sample time) before the voltage is above Level,
+MaxCount if it stays below.
+*/
+uint16_t RiseTimeADC(uint8_t tp, uint16_t Level, uint16_t MaxCount)
+{
+	uint16_t n = MaxCount;
+
+	Edge(tp, Level, 1, &n, ADC1_PRESSEL_FCPU_D18);
+	TraceADC(tp, MaxCount - n);
+
+	return (MaxCount - n);
+}
+
+/*
+Threshold event with the analog watchdog: the ADC converts tp continuously
+(fADC = fCPU/18, WATCH_US per conversion, long enough for nodes on R_H) and
+compares every result with the window in hardware. The CPU polls the AWD
+flag against the deadline, the conversions need no software.
+Returns as soon as the voltage is above (Rising) or below (!Rising) Level,
+after at least MaxMs otherwise (TIM2 ticks, up to 1 ms more).
+Returns the conversion that set AWD, past Level, or after the deadline the
+last one, not past Level. The caller decides on it (> Level or < Level):
+the window has already compared a conversion of the settled node, there is
+no second reading.
+*/
+uint16_t WatchADC(uint8_t tp, uint16_t Level, uint8_t Rising, uint16_t MaxMs)
+{
+	uint16_t end, value;
+
+	OpenADC(tp, ADC1_PRESSEL_FCPU_D18, ADC1_CONVERSIONMODE_CONTINUOUS);
+	ADC1_SetHighThreshold(Rising ? Level : 0x3FF);	//AWD: value > high or value < low
+	ADC1_SetLowThreshold(Rising ? 0 : Level);
+	ADC1_AWDChannelConfig(tp, ENABLE);
+	end = Ticks() + MsToTicks(MaxMs) + 1;	//the current tick is partly gone
+	ADC1_StartConversion();
+
+	while(!(ADC1->CSR & ADC1_CSR_AWD))
+	{
+		if ((int16_t)(Ticks() - end) >= 0)
+		{
+			break;
+		}
+	}
+
+	value = ADC1_GetConversionValue();	//the poll is far shorter than WATCH_US: still the result that set AWD
+	ADC1->CR1 &= (uint8_t)(~ADC1_CR1_CONT);
+	CloseADC();
+	TraceADC(tp, value);
+
+	return value;
+}
+
+/*
+Scan of the channels 0..last into the data buffer, count scans are summed up in sum[].
+The pin modes are not changed, so driven pins are read with their real output voltage.
+Sync: the scans are started by TIM1, spread over one mains period.
+*/
+static void Scan(uint8_t last, ADC1_PresSel_TypeDef pres, uint8_t count, uint16_t *sum, uint8_t Sync)
+{
+	uint8_t i, ch;
+
+	for(ch = 0; ch <= last; ch++)
+	{
+		sum[ch] = 0;
+	}
+
+	ADC1_DeInit();
+	ADC1_Init(ADC1_CONVERSIONMODE_SINGLE, last, pres,
+	ADC1_EXTTRIG_TIM, DISABLE, ADC1_ALIGN_RIGHT, last, DISABLE);
+	ADC1_ScanModeCmd(ENABLE);	//channels 0..last one after another into the buffer
+	if(Sync)
+	{
+		StartHum(count);
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		if(!Sync)
+		{
+			ADC1_StartConversion();
+		}
+		WaitEOC();	//EOC after the last channel
+		for(ch = 0; ch <= last; ch++)
+		{
+			sum[ch] += ADC1_GetBufferValue(ch);
+		}
+		ADC1_ClearFlag(ADC1_FLAG_EOC);
+	}
+
+	StopHum();
+	ADC1_DeInit();
+}
+
+/*
+Converts TP1..TP3 (ADC channels 0..2) in one scan into the data buffer,
+SCAN_COUNT scans are averaged.
+*/
+void ReadADCScan(uint16_t *adc)
+{
+	Scan(TP3, ADC1_PRESSEL_FCPU_D12, SCAN_COUNT, adc, 0);
+
+	adc[TP1] /= SCAN_COUNT;
+	adc[TP2] /= SCAN_COUNT;
+	adc[TP3] /= SCAN_COUNT;
+	TraceADC(TP1, adc[TP1]);
+	TraceADC(TP2, adc[TP2]);
+	TraceADC(TP3, adc[TP3]);
+}
+
+static void Pair(uint8_t tpA, uint8_t tpB, uint16_t *a, uint16_t *b, uint8_t Sync)
+{
+	uint16_t sum[3];
+	uint8_t count = Sync ? HUM_SAMPLES : PAIR_COUNT;
+
+	Scan((tpA > tpB) ? tpA : tpB, ADC1_PRESSEL_FCPU_D18, count, sum, Sync);
+
+	*a = sum[tpA] / count;
+	*b = sum[tpB] / count;
+	TraceADC(tpA, *a);
+	TraceADC(tpB, *b);
+}
+
+/*
+Paired reading of two testpoints: in every scan both channels are converted
+back-to-back (about 0.1 ms apart), PAIR_COUNT scans are interleaved and averaged,
+so both values belong to the same instant. The pin modes are not changed;
+a low pin driven to ground is read with its real voltage.
+fADC = fCPU/18 gives the longer sample time needed for nodes on R_H,
+the sampling capacitor comes from the other channel of the scan.
+*/
+void ReadADCPair(uint8_t tpA, uint8_t tpB, uint16_t *a, uint16_t *b)
+{
+	Pair(tpA, tpB, a, b, 0);
+}
+
+/*
+tpA and tpB as ReadADCPair, but the sums of the PAIR_COUNT scans: the means * 16,
+the noise of the ADC dithers the LSB. For a drop of a few LSB at an R_L, in a few ms
+instead of the mains period of ReadADCLong.
+*/
+void ReadADCPairFine(uint8_t tpA, uint8_t tpB, uint16_t *a, uint16_t *b)
+{
+	uint16_t sum[3];
+
+	Scan((tpA > tpB) ? tpA : tpB, ADC1_PRESSEL_FCPU_D18, PAIR_COUNT, sum, 0);
+
+	*a = sum[tpA] * (16 / PAIR_COUNT);
+	*b = sum[tpB] * (16 / PAIR_COUNT);
+	TraceADC(tpA, *a);
+	TraceADC(tpB, *b);
+}
+
+static uint16_t Diff(uint8_t tpHigh, uint8_t tpLow, uint16_t *low, uint8_t Sync)
+{
+	uint16_t h, l;
+
+	Pair(tpHigh, tpLow, &h, &l, Sync);
+	if (low)
+	{
+		*low = l;
+	}
+
+	return (h > l) ? (h - l) : 0;
+}
+
+/*
+Voltage between tpHigh and tpLow from one paired reading, 0 if negative.
+low (may be 0) receives the voltage of tpLow against ground.
+*/
+uint16_t ReadADCDiff(uint8_t tpHigh, uint8_t tpLow, uint16_t *low)
+{
+	return Diff(tpHigh, tpLow, low, 0);
+}
+
+/*
+As ReadADCDiff, but HUM_SAMPLES scans spread over one mains period (about 20 ms):
+for the nodes on R_H, where the burst of ReadADCDiff would catch the hum.
+*/
+uint16_t ReadADCDiffSync(uint8_t tpHigh, uint8_t tpLow, uint16_t *low)
+{
+	return Diff(tpHigh, tpLow, low, 1);
+}
+
+/*
+Mean of HUM_SAMPLES conversions of tp spread over one mains period.
+The pin modes are not changed, tp must not be driven.
+*/
+uint16_t ReadADCSync(uint8_t tp)
+{
+	uint16_t sum[3];
+
+	Scan(tp, ADC1_PRESSEL_FCPU_D18, HUM_SAMPLES, sum, 1);
+	sum[tp] /= HUM_SAMPLES;
+	TraceADC(tp, sum[tp]);
+
+	return sum[tp];
+}
+
+/*
+Equivalent time capture of a switching edge, for transients far shorter than
+one conversion (7 us at fADC = fCPU/2). Before every conversion GPIOC is held
+at Fwd for SWEEP_SETTLE_US, then TIM1 is started in one pulse mode and a fixed
+delay loop later Rev is written to GPIOC in one access. TIM1 triggers the
+conversion n + 2 timer clocks after its start (TRGO on update), so point n
+samples the same transient n / F_CPU later than point 0. Between the switch
+and the sample there is only hardware and a fixed instruction sequence, no
+interrupt and no polling. Trigger latency and sample aperture (3 ADC clocks)
+are the same for every point; a capture of a pin without a part gives the
+time of the edge. About 30 ms per capture.
+buf[n] receives the sum of SWEEP_REPEAT conversions of point n.
+*/
+void SweepADC(uint8_t tp, uint8_t Fwd, uint8_t Rev, uint16_t *buf)
+{
+	uint8_t n, r;
+	volatile uint8_t lead;
+
+	OpenADC(tp, ADC1_PRESSEL_FCPU_D2, ADC1_CONVERSIONMODE_SINGLE);
+	ADC1_ExternalTriggerConfig(ADC1_EXTTRIG_TIM, ENABLE);
+	TIM1->PSCRH = 0;
+	TIM1->PSCRL = 0;
+	TIM1->ARRH = 0;
+
+	for(n = 0; n < SWEEP_POINTS; n++)
+	{
+		buf[n] = 0;
+		for(r = 0; r < SWEEP_REPEAT; r++)
+		{
+			GPIOC->ODR = Fwd;
+			delay(US(SWEEP_SETTLE_US));
+			TIM1->CR1 = TIM1_CR1_OPM;
+			TIM1->CR2 = 0;
+			TIM1->ARRL = (uint8_t)(n + 1);	//ARR = 0 would block the counter
+			TIM1->EGR = TIM1_EGR_UG;	//counter 0, ARR loaded, before TRGO is connected
+			TIM1->CR2 = TIM1_MMS_UPDATE;
+			TIM1->CR1 = TIM1_CR1_OPM | TIM1_CR1_CEN;
+			for(lead = SWEEP_LEAD; lead; lead--)
+				;
+			GPIOC->ODR = Rev;
+			WaitEOC();
+			buf[n] += ADC1_GetConversionValue();
+			ADC1_ClearFlag(ADC1_FLAG_EOC);
+		}
+	}
+
+	GPIOC->ODR = Fwd;
+	StopHum();
+	CloseADC();
+
+#if TRACE
+	for(n = 0; n < SWEEP_POINTS; n++)
+	{
+		TraceADC(tp, buf[n]);	//after the capture, the records would shift the switch
+	}
+#endif
+}
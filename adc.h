@@ -0,0 +1,76 @@
+#ifndef __ADC_H__
+#define __ADC_H__
+
+//pins B0, B1, B2 - analog testpoints
+#define TP1 0
+//ADC1_CHANNEL_0
+#define TP2 1
+//ADC1_CHANNEL_1
+#define TP3 2
+//ADC1_CHANNEL_2
+
+#define ADC_SAMPLES 16		//conversions of ReadADC, maximum of ReadADCAbove
+#define ADC_SEQ_MIN 2		//minimum conversions of ReadADCAbove
+
+#define MAINS_HZ 50			//50 or 60: mains frequency of the bench, for the hum synchronous readings
+#define HUM_SAMPLES 16		//conversions of the ...Sync readings, spread over one mains period (at least 16)
+#define LEAK_SAMPLES 64		//conversions of ReadADCLong, spread over one mains period (at most 64, 16 bit sums)
+#define LEAK_SETTLE MS(1)	//R_L to R_H before ReadADCLong: 5 tau of R_H with up to 400 pF (junction and socket)
+#define SCAN_COUNT 8		//averaged scans of ReadADCScan
+#define PAIR_COUNT 16		//averaged scans of ReadADCPair, summed by ReadADCPairFine (at most 16)
+
+#define EDGE_TIMEOUT 250	//WaitADC: about 5 ms
+#define LATCH_WINDOW 50		//WaitADC: about 1 ms
+#define RISE_US 150			//RiseTimeADC: one conversion at fADC = fCPU/18
+#define WATCH_US 126		//WatchADC: one conversion at fADC = fCPU/18, latency of the event
+
+#define SWEEP_POINTS 32		//SweepADC: points of one capture, 1/F_CPU (0.5 us) apart
+#define SWEEP_REPEAT 4		//SweepADC: conversions summed per point, against the jitter of the ADC clock
+#define SWEEP_SETTLE_US 200	//SweepADC: pins at Fwd before every switch
+#define SWEEP_LEAD 2		//SweepADC: delay loops from the start of TIM1 to the switch, about 16 clocks
+#define SWEEP_APERTURE 6	//SweepADC: points covered by one sample aperture (3 ADC clocks)
+
+#define EOC_TIMEOUT 1000	//polls of the EOC flag, at least 2 ms
+
+extern uint8_t ADCTimeout;	//an EOC did not come, set until cleared by the caller
+
+typedef struct
+{
+	uint16_t Mean;
+	uint16_t Spread;	//standard deviation of the single conversions
+	uint8_t Count;		//number of conversions taken
+} ADCStat;
+
+uint16_t ReadADC(uint8_t tp);
+
+uint16_t ReadADCStat(uint8_t tp, ADCStat *stat);
+
+uint16_t ReadADCCoarse(uint8_t tp);
+
+uint8_t ReadADCAbove(uint8_t tp, uint16_t Level, uint8_t Margin, ADCStat *stat);
+
+#define ReadADCBelow(tp, Level, Margin, stat) (!ReadADCAbove(tp, (Level) - 1, Margin, stat))
+
+uint16_t ReadADCLong(uint8_t tp);
+
+uint16_t ReadADCSync(uint8_t tp);
+
+uint16_t WaitADC(uint8_t tp, uint16_t Level, uint8_t Rising, uint16_t MaxCount);
+
+uint16_t RiseTimeADC(uint8_t tp, uint16_t Level, uint16_t MaxCount);
+
+uint16_t WatchADC(uint8_t tp, uint16_t Level, uint8_t Rising, uint16_t MaxMs);
+
+void ReadADCScan(uint16_t *adc);
+
+void ReadADCPair(uint8_t tpA, uint8_t tpB, uint16_t *a, uint16_t *b);
+
+void ReadADCPairFine(uint8_t tpA, uint8_t tpB, uint16_t *a, uint16_t *b);
+
+uint16_t ReadADCDiff(uint8_t tpHigh, uint8_t tpLow, uint16_t *low);
+
+uint16_t ReadADCDiffSync(uint8_t tpHigh, uint8_t tpLow, uint16_t *low);
+
+void SweepADC(uint8_t tp, uint8_t Fwd, uint8_t Rev, uint16_t *buf);
+
+#endif
@@ -0,0 +1,164 @@
+#include "stm8s.h"
+#include "delay.h"
+#include "adc.h"
+#include "tester.h"
+#include "curve.h"
+#include "serial.h"
+#include "watchdog.h"
+
+#if CURVE
+
+static struct
+{
+	uint8_t pins;
+	uint8_t n;
+	uint8_t pt[CURVE_POINTS][4];
+} gCurve;
+
+/*
+Junction for the plot: diode, B-E of a transistor, gate-cathode of a
+thyristor, G-S of a JFET, body diode (S-D) of a MOSFET; TP1-TP2 otherwise
+*/
+static uint8_t Junction(TestContext *tc)
+{
+	switch (tc->PartFound)
+	{
+	case PART_DIODE:
+	case PART_NETWORK:
+		return (uint8_t)((tc->diodes[0].Anode << 4) | tc->diodes[0].Cathode);
+	case PART_TRANSISTOR:
+		if (tc->PartMode == PART_MODE_NPN)
+		{
+			return (uint8_t)((tc->b << 4) | tc->e);
+		}
+		return (uint8_t)((tc->e << 4) | tc->b);
+	case PART_THYRISTOR:
+	case PART_TRIAC:
+		return (uint8_t)((tc->b << 4) | tc->e);
+	case PART_FET:
+		if (tc->PartMode == PART_MODE_N_JFET)
+		{
+			return (uint8_t)((tc->b << 4) | tc->e);
+		}
+		if (tc->PartMode == PART_MODE_P_JFET)
+		{
+			return (uint8_t)((tc->e << 4) | tc->b);
+		}
+		if (tc->PartMode & 1)	//N-channel: body diode from source to drain
+		{
+			return (uint8_t)((tc->e << 4) | tc->c);
+		}
+		return (uint8_t)((tc->c << 4) | tc->e);
+	}
+
+	return (TP1 << 4) | TP2;
+}
+
+//hi side to Vcc and lo side to ground, each firm or over its resistor
+static void Drive(uint8_t hi, uint8_t lo, uint8_t cfg)
+{
+	uint8_t b = 0, bo = 0, c = 0, co = 0;
+	uint8_t side = cfg & 3;
+
+	if (side == CURVE_FIRM)
+	{
+		b = bo = (uint8_t)(1 << hi);
+	}
+	else
+	{
+		c = co = (uint8_t)(side << (hi * 2 + 1));	//R_L: 1 << n, R_H: 2 << n
+	}
+	side = (cfg >> 2) & 3;
+	if (side == CURVE_FIRM)
+	{
+		b |= (uint8_t)(1 << lo);
+	}
+	else
+	{
+		c |= (uint8_t)(side << (lo * 2 + 1));
+	}
+
+	GPIOB->ODR = bo;
+	GPIOB->CR1 = b;
+	GPIOB->DDR = b;
+	GPIOC->ODR = co;
+	GPIOC->CR1 = c;
+	GPIOC->DDR = c;
+}
+
+/*
+One buffered pass over all drive combinations, about 25 ms per point
+(5 ms settling for the R_H nodes, 20 ms hum synchronous reading).
+*/
+void CurveCapture(TestContext *tc)
+{
+	uint8_t a, k, hi, lo, rev, src, snk;
+	uint16_t vh, vl;
+
+	gCurve.n = 0;
+	if (tc->Charged == CHARGE_HELD)
+	{
+		return;		//not tested, the part is still charged
+	}
+	gCurve.pins = CURVE_PAIR ? (uint8_t)(CURVE_PAIR - 0x11) : Junction(tc);
+	a = gCurve.pins >> 4;
+	k = gCurve.pins & 15;
+
+	for (rev = 0; rev < 2; rev++)
+	{
+		hi = rev ? k : a;
+		lo = rev ? a : k;
+		for (src = CURVE_FIRM; src <= CURVE_RH; src++)
+		{
+			for (snk = CURVE_FIRM; snk <= CURVE_RH; snk++)
+			{
+				if ((src == CURVE_FIRM) && (snk == CURVE_FIRM))
+				{
+					continue;	//short circuit
+				}
+				WdtReset();
+				Drive(hi, lo, (uint8_t)(src | (snk << 2)));
+				delay(MS(5));
+				vh = ReadADCDiffSync(hi, lo, &vl) + vl;
+				gCurve.pt[gCurve.n][0] = (uint8_t)((rev ? CURVE_REVERSE : 0) | src | (snk << 2));
+				gCurve.pt[gCurve.n][1] = (uint8_t)(vh >> 2);
+				gCurve.pt[gCurve.n][2] = (uint8_t)(vl >> 2);
+				gCurve.pt[gCurve.n][3] = (uint8_t)(((vh & 3) << 2) | (vl & 3));
+				gCurve.n++;
+			}
+		}
+	}
+
+	GPIOB->DDR = 0;
+	GPIOB->CR1 = 0;
+	GPIOB->ODR = 0;
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+	GPIOC->ODR = 0;
+}
+
+//the frame of curve.h, about 150 ms at 9600 baud
+void CurveSend(void)
+{
+	uint8_t i, j, sum;
+
+	SerialOpen(CURVE_BAUD);
+	SerialSend('#');
+	SerialHex(gCurve.pins);
+	SerialHex(gCurve.n);
+	sum = gCurve.pins + gCurve.n;
+	for (i = 0; i < gCurve.n; i++)
+	{
+		for (j = 0; j < 4; j++)
+		{
+			SerialHex(gCurve.pt[i][j]);
+			sum += gCurve.pt[i][j];
+		}
+	}
+	SerialHex(sum);
+	SerialSend('\r');
+	SerialSend('\n');
+	SerialClose();
+}
+
+#endif
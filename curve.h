@@ -0,0 +1,41 @@
+#ifndef __CURVE_H__
+#define __CURVE_H__
+
+/*
+Curve mode: I-V points of one junction for a plot on the host
+(tools/ivplot.py). After the test of socket 1 the junction is driven with
+every combination of the probe drivers, in both polarities:
+  high side  firm Vcc, R_L or R_H to Vcc
+  low side   firm GND, R_L or R_H to GND   (not firm on both sides)
+This gives 8 points per polarity, from about 6 mA (R_L) over 3 mA (R_L + R_L)
+down to 4.5 uA (R_H + R_H). Both pin voltages are read in the same scan,
+over one mains period (ReadADCDiffSync); the host computes U and I.
+
+Frame, one line of hex text after the result is shown:
+  '#' pins  count  count * (cfg  hi[9:2]  lo[9:2]  hi[1:0] << 2 | lo[1:0])  sum  CR LF
+  pins  anode << 4 | cathode of the junction (TP1..TP3 = 0..2)
+  cfg   bit 0-1 high side, bit 2-3 low side (CURVE_FIRM/RL/RH),
+        bit 7 reverse: the cathode is the high side
+  sum   low byte of the sum of all bytes from pins on
+*/
+#define CURVE 0				//1 = curve mode in the firmware
+
+#define CURVE_PAIR 0		//0 = the identified junction, else (anode + 1) << 4 | (cathode + 1)
+#define CURVE_POINTS 16
+#define CURVE_BAUD 9600		//UART2 TX on PD5
+
+#define CURVE_FIRM 0		//drive of one side: pin of GPIOB
+#define CURVE_RL 1			//over R_L, the GPIOC pin tp*2+1
+#define CURVE_RH 2			//over R_H, the GPIOC pin tp*2+2
+#define CURVE_REVERSE 0x80
+
+#if CURVE
+void CurveCapture(TestContext *tc);
+
+void CurveSend(void);
+#else
+#define CurveCapture(tc) ((void)0)
+#define CurveSend() ((void)0)
+#endif
+
+#endif
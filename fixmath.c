@@ -0,0 +1,115 @@
+#include "stm8s.h"
+#include "fixmath.h"
+
+/*
+v * q / 2^16, q is a Q16 scale factor.
+The result is truncated: error below 1 + v / 2^16 units of the result
+(q itself is truncated to 16 fraction bits), i.e. below 2 units for 10 bit
+ADC values and the factors of fixmath.h.
+*/
+uint16_t FixMul(uint16_t v, uint32_t q)
+{
+	return (uint16_t)(((uint32_t)v * q) >> 16);
+}
+
+//1 / x in Q15 for x = (128.5 .. 255.5) / 256, the seed of FixDiv
+static const uint16_t gRecip[128] =
+{
+	65281, 64777, 64281, 63792, 63310, 62836, 62369, 61909,
+	61455, 61008, 60568, 60133, 59705, 59283, 58867, 58457,
+	58053, 57654, 57260, 56872, 56489, 56111, 55738, 55370,
+	55007, 54649, 54295, 53946, 53601, 53261, 52925, 52593,
+	52265, 51942, 51622, 51306, 50995, 50686, 50382, 50081,
+	49784, 49490, 49200, 48913, 48630, 48349, 48072, 47798,
+	47528, 47260, 46995, 46733, 46474, 46218, 45965, 45714,
+	45467, 45222, 44979, 44739, 44502, 44267, 44035, 43805,
+	43577, 43352, 43129, 42908, 42690, 42474, 42260, 42048,
+	41838, 41631, 41425, 41222, 41020, 40820, 40623, 40427,
+	40233, 40041, 39851, 39662, 39476, 39291, 39108, 38926,
+	38746, 38568, 38392, 38217, 38044, 37872, 37702, 37533,
+	37366, 37200, 37036, 36873, 36712, 36552, 36393, 36236,
+	36080, 35926, 35772, 35620, 35470, 35320, 35172, 35026,
+	34880, 34735, 34592, 34450, 34309, 34169, 34031, 33893,
+	33757, 33622, 33487, 33354, 33222, 33091, 32961, 32832
+};
+
+/*
+n / d without a division, n below 2^31: d is normalized to x = d * 2^s / 2^16
+(0.5 .. 1), the top bits of x give 1 / x from gRecip to 9 bits, one Newton
+step r * (2 - x * r) refines it to a Q15 reciprocal, and n * r is shifted
+back by s. The result is truncated: error below n / d / 2^13 + 2 units.
+d = 0 gives 0xFFFFFFFF.
+*/
+uint32_t FixDiv(uint32_t n, uint16_t d)
+{
+	uint8_t s = 0;
+	uint32_t r;
+
+	if (!d)
+	{
+		return 0xFFFFFFFFUL;
+	}
+	while (d < 0x8000)
+	{
+		d <<= 1;
+		s++;
+	}
+	r = gRecip[(d >> 8) & 0x7F];
+	r = (r * (0x10000UL - (((uint32_t)d * r + 0xFFFF) >> 16))) >> 15;
+
+	return (((n >> 16) * r) >> (15 - s)) + (((n & 0xFFFF) * r) >> (31 - s));
+}
+
+/*
+log2(x) with 4 fraction bits, x >= 1.
+The mantissa is normalized to 1.0 .. 2.0 (Q15), five fraction bits come
+from repeated squaring and are rounded to four: the squaring truncates,
+so four bits alone would fall a step short just above a step of the
+result. Error below 1/32 + 1/1000.
+*/
+uint16_t Log2Q4(uint32_t x)
+{
+	int8_t e = 15;
+	uint16_t r;
+	uint8_t bit;
+
+	while (x >= 0x10000)
+	{
+		x >>= 1;
+		e++;
+	}
+	while (x < 0x8000)
+	{
+		x <<= 1;
+		e--;
+	}
+	r = e << 5;
+	for (bit = 16; bit; bit >>= 1)
+	{
+		x = (x * x) >> 15;
+		if (x >= 0x10000)
+		{
+			x >>= 1;
+			r += bit;
+		}
+	}
+
+	return (r + 1) >> 1;
+}
+
+//floor(sqrt(x)), bit by bit from the top
+uint16_t FixSqrt(uint32_t x)
+{
+	uint16_t r = 0, bit = 0x8000;
+
+	while (bit)
+	{
+		if ((uint32_t)(r | bit) * (r | bit) <= x)
+		{
+			r |= bit;
+		}
+		bit >>= 1;
+	}
+
+	return r;
+}
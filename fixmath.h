@@ -0,0 +1,35 @@
+#ifndef __FIXMATH_H__
+#define __FIXMATH_H__
+
+/*
+Exact values of the resistors used (see rlval/rhval in main.c).
+All scale factors below are folded by the compiler into Q16 constants,
+so every conversion is one 16x32 bit multiplication and a shift.
+*/
+#define RL_OHM 672			//R_L; Normwert 680 Ohm
+#define RH_100 4690			//R_H; Normwert 470000 Ohm, durch 100 dividiert
+#define PORT_OHM 20			//Ausgangswiderstand eines Port-Treibers bei 5 V, typisch
+
+#define Q_MV ((5000UL << 16) / 1023)				//mV per LSB
+#define Q_UA_RL ((4888UL << 16) / RL_OHM)			//uA per LSB over R_L
+#define Q_UA_RH ((4888UL << 16) / (RH_100 * 100UL))	//uA per LSB over R_H
+#define Q_NA_RH ((48880UL << 16) / RH_100)			//nA per LSB over R_H
+#define Q_NA_LEAK ((3055UL << 16) / RH_100)			//nA per LSB/16 over R_H (ReadADCLong)
+#define Q_PORT_RL ((PORT_OHM * 65536UL) / (RL_OHM + PORT_OHM))	//share of the driver in the drop over driver and R_L
+
+#define RH_RL_RATIO ((RH_100 * 100UL) / RL_OHM)	//R_H / R_L
+
+#define AdcToMv(adc) FixMul(adc, Q_MV)
+#define AdcToUaRL(adc) FixMul(adc, Q_UA_RL)
+#define AdcToUaRH(adc) FixMul(adc, Q_UA_RH)
+#define AdcToNaRH(adc) FixMul(adc, Q_NA_RH)
+
+uint16_t FixMul(uint16_t v, uint32_t q);
+
+uint32_t FixDiv(uint32_t n, uint16_t d);
+
+uint16_t Log2Q4(uint32_t x);
+
+uint16_t FixSqrt(uint32_t x);
+
+#endif
@@ -1,1022 +1,2430 @@
-#include "stm8s.h"
-#include "stm8s_adc1.h"
-#include "stm8s_clk.h"
-#include "delay.h"
-#include "HD44780.h"
-
-//pins C1-C6 - digital probes
-//pins B0, B1, B2 - analog testpoints
-#define TP1 0
-//ADC1_CHANNEL_0
-#define TP2 1
-//ADC1_CHANNEL_1
-#define TP3 2
-//ADC1_CHANNEL_2
-
-/* Settings for capacitance measurement (for ATMega8 interesting)
-The test of whether there is a capacitor takes a relatively long time, with more than 50 ms per test procedure is expected to
-In all six possible test events is an extension of the test period by about 0.3 s to 0.5 s.
-With CAP_TEST_MODE used to set the tests.
-
-Meanings of the bits (7 = MSB):
-7:6 not used
-
-5-4 Test Mode
-00: capacitor measurement disabled
-01: capacitor measurement for an adjustable pin combination (both ways), extended testing time by about 200ms 120th ..
-10: capacitor measurement for every 6-pin combinations, extended test times by about 300 .. 500ms
-
-3:2 The first pin of the pin-selected combination (0 .. 2), only decisive when bits 5:4 = 01
-
-1-0 second pin of the pin-selected combination (0 .. 2), only important when bits 5:4 = 01
-*/
-uint8_t ctmode = 0b00100010; // measure for all 6-pin combinations
-
-/*
-Exact values of the resistors used in ohms.
-The nominal value for R_L is 680 ohms, for 470kOhm R_H
-The program for deviations from these values (eg due to component tolerances)
-To calibrate, enter the resistor values in ohms in the following defines:
-*/
-const	unsigned int rlval = 672;			//R_L; Normwert 680 Ohm
-const	unsigned int rhval = 4690;		//R_H; Normwert 470000 Ohm, durch 100 dividiert angeben
-
-/*
-Factors for Kapatitatsmessung with capacitors
-These factors depend on manufacturing tolerances from the AVR and thus have to be adjusted, if necessary
-H_CAPACITY_FACTOR for the test with 470k resistor (low capacity)
-L_CAPACITY_FACTOR for the measurement with 680-ohm resistor (high capacity)
-The entire range is about 0.2 nF to 7300?F.
-*/
-const	unsigned int H_CAPACITY_FACTOR = 394;
-const	unsigned int L_CAPACITY_FACTOR = 283;
-
-const	unsigned char TestRunning[]  = "Testing ...";
-const	unsigned char Bat[]  = "Battery ";
-const	unsigned char BatWeak[]  = "weak";
-const	unsigned char BatEmpty[]  = "empty!";
-const	unsigned char TestFailed1[]  = "No, unknown, or";
-const	unsigned char TestFailed2[]  = "damaged ";
-const	unsigned char Bauteil[]  = "part";
-const	unsigned char Unknown[]  = " unknown";
-const	unsigned char Diode[]  = "Diode: ";
-const	unsigned char DualDiode[]  = "Double diode ";
-const	unsigned char TwoDiodes[]  = "2 diodes";
-const	unsigned char Antiparallel[]  = "anti-parallel";
-const	unsigned char InSeries[]  = "serial A=";
-const	unsigned char K1[]  = ";C1=";
-const	unsigned char K2[]  = ";C2=";
-const	unsigned char GAK[]  = "GAC=";
-const	unsigned char NextK[]  = ";C=";
-const	unsigned char K[]  = "C=";
-const	unsigned char Triac[]  = "Triac";
-const	unsigned char Thyristor[]  = "Thyristor";
-const unsigned char OrBroken[]  = "or damaged ";
-const	unsigned char Resistor[]  = "Resistor: ";
-const	unsigned char Capacitor[]  = "Capacitor: ";
-const	unsigned char mosfet[]  = "-MOS";
-const	unsigned char emode[]  = "-E";
-const	unsigned char dmode[]  = "-D";
-const	unsigned char jfet[]  = "-JFET";
-const	unsigned char A1[]  = ";A1=";
-const	unsigned char A2[]  = ";A2=";
-const	unsigned char NullDot[]  = "0,";
-const	unsigned char GateCap[]  = " C=";
-const	unsigned char hfestr[]  ="hFE=";
-const	unsigned char NPN[]  = "NPN";
-const	unsigned char PNP[]  = "PNP";
-const	unsigned char bstr[]  = " B=";
-const	unsigned char cstr[]  = ";C=";
-const	unsigned char estr[]  = ";E=";
-const	unsigned char gds[]  = "GDS=";
-const	unsigned char Uf[]  = "Uf=";
-const	unsigned char vt[]  = "Vt=";
-const	unsigned char mV[]  = "mV";
-const	unsigned char Anode[]  = "A=";
-const	unsigned char Gate[]  = "G=";
-const	unsigned char CA[]  = "CA";
-const	unsigned char CC[]  = "CC";
-const	unsigned char TestTimedOut[]  = "Timeout!";
-
-const	unsigned char DiodeIcon[]  = {4,31,31,14,14,4,31,4,0};	//Dioden-Icon
-
-/*If the define "WDT_enabled" removed, the watchdog on startup
-  no longer active. This is useful for testing and debugging purposes.
-  For normal use of the tester, the watchdog should also be activated without fail!
-*/
-//#define WDT_enabled
-
-uint16_t ReadADC(uint8_t tp)
-{
-	uint8_t i;
-	uint16_t value = 0;
-	uint8_t oldCr = GPIOB->CR1;
-	uint8_t oldDdr = GPIOB->DDR;
-	
-	GPIOB->DDR &= (uint8_t)(~(1 << tp));
-	GPIOB->CR1 &= (uint8_t)(~(1 << tp));
-	GPIOB->CR2 &= (uint8_t)(~(1 << tp));
-	
-	ADC1_DeInit();
-	ADC1_Init(ADC1_CONVERSIONMODE_SINGLE, tp, ADC1_PRESSEL_FCPU_D12,
-	ADC1_EXTTRIG_TIM, DISABLE, ADC1_ALIGN_RIGHT, tp, DISABLE);
-
-	for( i = 0; i < 16; i++)
-	{
-		ADC1_StartConversion();
-		while(!ADC1_GetFlagStatus(ADC1_FLAG_EOC))
-			;
-		value += ADC1_GetConversionValue(); // read ADC conversion data, the first low, then high
-	}
-	
-	ADC1_DeInit();
-
-	GPIOB->DDR = oldDdr;
-	GPIOB->CR1 = oldCr;
-
-	return (value >> 4);
-}
-
-struct Diode {
-	uint8_t Anode;
-	uint8_t Cathode;
-	int Voltage;
-};
-
-void CheckPins(uint8_t HighPin, uint8_t LowPin, uint8_t TristatePin);
-void DischargePin(uint8_t PinToDischarge, uint8_t DischargeDirection);
-void lcd_show_format_cap(char outval[], uint8_t strlength, uint8_t CommaPos);
-void ReadCapacity(uint8_t HighPin, uint8_t LowPin);		//Kapazitatsmessung nur auf Mega8 verfugbar
-
-void itoa(uint32_t v, char *buf)
-{
-	char tmp[17];
-	int8_t i = 0;
-	
-	while(v != 0)
-	{
-		tmp[i++] = '0' + v % 10;
-		v /= 10;
-	}
-	
-	if (i == 0)
-	{
-		*buf++ = '0';
-	}
-	else
-	{
-		for (; i > 0; i--)
-		{
-			*buf++ = tmp[i-1];
-		}
-	}
-	
-	*buf = 0;
-}
-
-#define PART_NONE 0
-#define PART_DIODE 1
-#define PART_TRANSISTOR 2
-#define PART_FET 3
-#define PART_TRIAC 4
-#define PART_THYRISTOR 5
-#define PART_RESISTOR 6
-#define PART_CAPACITOR 7
-
-#define PART_MODE_N_E_MOS 1
-#define PART_MODE_P_E_MOS 2
-#define PART_MODE_N_D_MOS 3
-#define PART_MODE_P_D_MOS 4
-#define PART_MODE_N_JFET 5
-#define PART_MODE_P_JFET 6
-
-#define PART_MODE_NPN 1
-#define PART_MODE_PNP 2
-
-struct Diode diodes[6];
-uint8_t NumOfDiodes;
-
-uint8_t b,c,e;			//Anschlusse des Transistors
-unsigned long lhfe;		//Verstarkungsfaktor
-uint8_t PartReady;		//Bauteil fertig erkannt
-unsigned int hfe[2];		//Verstarkungsfaktoren
-unsigned int uBE[2];	//B-E-Spannung fur Transistoren
-uint8_t PartMode;
-uint8_t tmpval, tmpval2;
-
-uint8_t ra, rb;				//Widerstands-Pins
-unsigned int rv[2];			//Spannungsabfall am Widerstand
-unsigned int radcmax[2];	//Maximal erreichbarer ADC-Wert (geringer als 1023, weil Spannung am Low-Pin bei Widerstandsmessung uber Null liegt)
-uint8_t ca, cb;				//Kondensator-Pins
-uint8_t cp1, cp2;			//Zu testende Kondensator-Pins, wenn Messung fur einzelne Pins gewahlt
-
-unsigned long cv;
-
-uint8_t PartFound, tmpPartFound;	//das gefundene Bauteil
-char outval[8];
-unsigned int adcv[4];
-unsigned int gthvoltage;	//Gate-Schwellspannung
-uint8_t tmpval, tmpval2;
-
-char outval2[6];
-
-int main(void) 
-{
-	uint16_t value;
-	char tmpBuf[17];
-
-	GPIO_DeInit(GPIOB);
-	GPIO_DeInit(GPIOC);
-
-	//InitClocks();
-	
-	InitLcd(GPIOD, GPIO_PIN_2, GPIO_PIN_3, GPIO_PIN_HNIB);
-////////////////////////////////////
-	//TODO ADC Prescaler = 8
-	cp1 = (ctmode & 12) >> 2;
-	cp2 = ctmode & 3;
-	ctmode = (ctmode & 48) >> 4;
-  //TODO watchdog 2s
-	//!!SendCommand(0x40);//custom character
-	//!!Out((char *)DiodeIcon);
-	//!!SendData(0);
-	PartFound = PART_NONE;
-	tmpPartFound = PART_NONE;
-	NumOfDiodes = 0;
-	PartReady = 0;
-	PartMode = 0;
-	ca = 0;
-	cb = 0;
-	ClearLcd(0);
-	Outline(0, TestRunning);
-	CheckPins(TP1, TP2, TP3);
-	CheckPins(TP1, TP3, TP2);
-	CheckPins(TP2, TP1, TP3);
-	CheckPins(TP2, TP3, TP1);
-	CheckPins(TP3, TP2, TP1);
-	CheckPins(TP3, TP1, TP2);
-
-/*	if(((PartFound == PART_NONE) || (PartFound == PART_RESISTOR) || (PartFound == PART_DIODE)) && (ctmode > 0)) {
-		//Kondensator entladen; sonst ist evtl. keine Messung moglich
-			R_PORT = 0;
-			R_DDR = (1<<(TP1 * 2)) | (1<<(TP2 * 2)) | (1<<(TP3 * 2));
-			_delay_ms(10);
-			R_DDR = 0;
-		//Kapazitat in allen 6 Pin-Kombinationen messen
-		if(ctmode == 1) {
-			ReadCapacity(cp1, cp2);
-			ReadCapacity(cp2, cp1);
-		} else {
-			ReadCapacity(TP3, TP1);
-			ReadCapacity(TP3, TP2);
-			ReadCapacity(TP2, TP3);
-			ReadCapacity(TP2, TP1);
-			ReadCapacity(TP1, TP3);
-			ReadCapacity(TP1, TP2);
-		}
-	}*/
-
-	ClearLcd(0);
-	if(PartFound == PART_DIODE) {
-		if(NumOfDiodes == 1) {
-			//Standard-Diode
-			Out(Diode);	//"Diode: "
-			Out(Anode);
-			SendData(diodes[0].Anode + 49);
-			Out(NextK);//";K="
-			SendData(diodes[0].Cathode + 49);
-			SetLine(1);	//2. Zeile
-			Out(Uf);	//"Uf = "
-			itoa(diodes[0].Voltage, tmpBuf);
-			Out(tmpBuf);
-			//lcd_string(itoa(diodes[0].Voltage, outval, 10));
-			Out(mV);
-			goto end;
-		} else if(NumOfDiodes == 2) {
-		//Doppeldiode
-			if(diodes[0].Anode == diodes[1].Anode) {
-				//Common Anode
-				Out(DualDiode);	//Doppeldiode
-				Out(CA);	//"CA"	
-				SetLine(1); //2. Zeile
-				Out(Anode);
-				SendData(diodes[0].Anode + 49);
-				Out(K1);	//";K1="
-				SendData(diodes[0].Cathode + 49);
-				Out(K2);	//";K2="
-				SendData(diodes[1].Cathode + 49);
-				goto end;
-			} else if(diodes[0].Cathode == diodes[1].Cathode) {
-				//Common Cathode
-				Out(DualDiode);	//Doppeldiode
-				Out(CC);	//"CC"
-				SetLine(1); //2. Zeile
-				Out(K);	//"K="
-				SendData(diodes[0].Cathode + 49);
-				Out(A1);		//";A1="
-				SendData(diodes[0].Anode + 49);
-				Out(A2);		//";A2="
-				SendData(diodes[1].Anode + 49);
-				goto end;
-			} else if ((diodes[0].Cathode == diodes[1].Anode) && (diodes[1].Cathode == diodes[0].Anode)) {
-				//Antiparallel
-				Out(TwoDiodes);	//2 Dioden
-				SetLine(1); //2. Zeile
-				Out(Antiparallel);	//Antiparallel
-				goto end;
-			}
-		} else if(NumOfDiodes == 3) {
-			//Serienschaltung aus 2 Dioden; wird als 3 Dioden erkannt
-			b = 3;
-			c = 3;
-			/* Uberprufen auf eine fur eine Serienschaltung von 2 Dioden mogliche Konstellation
-				Dafur mussen 2 der Kathoden und 2 der Anoden ubereinstimmen.
-				Das kommmt daher, dass die Dioden als 2 Einzeldioden und ZUSATZLICH als eine "gro?e" Diode erkannt werden.
-			*/
-			if((diodes[0].Anode == diodes[1].Anode) || (diodes[0].Anode == diodes[2].Anode)) b = diodes[0].Anode;
-			if(diodes[1].Anode == diodes[2].Anode) b = diodes[1].Anode;
-
-			if((diodes[0].Cathode == diodes[1].Cathode) || (diodes[0].Cathode == diodes[2].Cathode)) c = diodes[0].Cathode;
-			if(diodes[1].Cathode == diodes[2].Cathode) c = diodes[1].Cathode;
-			if((b<3) && (c<3)) {
-				Out(TwoDiodes);//2 Dioden
-				SetLine(1); //2. Zeile
-				Out(InSeries); //"in Serie A="
-				SendData(b + 49);
-				Out(NextK);
-				SendData(c + 49);
-				goto end;
-			}
-		}
-	} else if (PartFound == PART_TRANSISTOR) {
-		if(PartReady == 0) {	//Wenn 2. Prufung nie gemacht, z.B. bei Transistor mit Schutzdiode
-			hfe[1] = hfe[0];
-			uBE[1] = uBE[0];
-		}
-		if((hfe[0]>hfe[1])) {	//Wenn der Verstarkungsfaktor beim ersten Test hoher war: C und E vertauschen!
-			uint8_t tmp;
-			hfe[1] = hfe[0];
-			uBE[1] = uBE[0];
-			tmp = c;
-			c = e;
-			e = tmp;
-		}
-
-		if(PartMode == PART_MODE_NPN) {
-			Out(NPN);
-		} else {
-			Out(PNP);
-		}
-		Out(bstr);	//B=
-		SendData(b + 49);
-		Out(cstr);	//;C=
-		SendData(c + 49);
-		Out(estr);	//;E=
-		SendData(e + 49);
-		SetLine(1); //2. Zeile
-		//Verstarkungsfaktor berechnen
-		//hFE = Emitterstrom / Basisstrom
-		lhfe = hfe[1];
-
-//TODO		#ifdef UseM8
-			lhfe *= (((unsigned long)rhval * 100) / (unsigned long)rlval);	//Verhaltnis von High- zu Low-Widerstand
-//		#else
-//			lhfe *= M48_RH_RL_RATIO;
-//		#endif
-		if(uBE[1]<11) uBE[1] = 11;
-		lhfe /= uBE[1];
-		hfe[1] = (unsigned int) lhfe;
-		Out(hfestr);	//"hFE="
-		itoa(hfe[1], tmpBuf);
-		Out(tmpBuf);
-		//lcd_string(utoa(hfe[1], outval, 10));
-		SetCursor(2,7);			//Cursor auf Zeile 2, Zeichen 7
-		if(NumOfDiodes > 2) {	//Transistor mit Schutzdiode
-			//TODO lcd_data(LCD_CHAR_DIODE);	//Diode anzeigen
-			SendData('D');
-		} else {
-//			#ifdef UseM8
-				SendData(' ');
-//			#endif
-		}
-//		#ifdef UseM8
-			for(c=0;c<NumOfDiodes;c++) {
-				if(((diodes[c].Cathode == e) && (diodes[c].Anode == b) && (PartMode == PART_MODE_NPN)) || ((diodes[c].Anode == e) && (diodes[c].Cathode == b) && (PartMode == PART_MODE_PNP))) {
-					Out(Uf);	//"Uf="
-					itoa(diodes[c].Voltage, tmpBuf);
-					Out(tmpBuf);
-					SendData('m');
-					goto end;
-				}
-			}
-//		#endif
-		goto end;
-	} else if (PartFound == PART_FET) {	//JFET oder MOSFET
-		if(PartMode&1) {	//N-Kanal
-			SendData('N');
-		} else {
-			SendData('P');	//P-Kanal
-		}
-		if((PartMode==PART_MODE_N_D_MOS) || (PartMode==PART_MODE_P_D_MOS)) {
-			Out(dmode);	//"-D"
-			Out(mosfet);	//"-MOS"
-		} else {
-			if((PartMode==PART_MODE_N_JFET) || (PartMode==PART_MODE_P_JFET)) {
-				Out(jfet);	//"-JFET"
-			} else {
-				Out(emode);	//"-E"
-				Out(mosfet);	//"-MOS"
-			}
-		}
-/*TODO		#ifdef UseM8	//Gatekapazitat
-			if(PartMode < 3) {	//Anreicherungs-MOSFET
-				lcd_eep_string(GateCap);	//" C="
-				ReadCapacity(b,e);	//Messung
-				hfe[0] = (unsigned int)cv;
-				if(hfe[0]>2) hfe[0] -= 3;
-				utoa(hfe[0], outval2, 10);
-
-				tmpval = strlen(outval2);
-				tmpval2 = tmpval;
-				if(tmpval>4) tmpval = 4;	//bei Kapazitat >100nF letze Nachkommastelle nicht mehr angeben (passt sonst nicht auf das LCD)
-				lcd_show_format_cap(outval2, tmpval, tmpval2);
-				lcd_data('n');
-			}
-		#endif*/
-		SetLine(1); //2. Zeile
-		Out(gds);	//"GDS="
-		SendData(b + 49);
-		SendData(c + 49);
-		SendData(e + 49);
-		if((NumOfDiodes > 0) && (PartMode < 3)) {	//MOSFET mit Schutzdiode; gibt es nur bei Anreicherungs-FETs
-			//TODO lcd_data(LCD_CHAR_DIODE);	//Diode anzeigen
-			SendData('D');
-		} else {
-			SendData(' ');	//Leerzeichen
-		}
-		if(PartMode < 3) {	//Anreicherungs-MOSFET
-			gthvoltage=(gthvoltage/8);
-			Out(vt);
-			itoa(gthvoltage, tmpBuf);
-			Out(tmpBuf);	//Gate-Schwellspannung, wurde zuvor ermittelt
-			SendData('m');
-		}
-		goto end;
-	} else if (PartFound == PART_THYRISTOR) {
-		Out(Thyristor);	//"Thyristor"
-		SetLine(1); //2. Zeile
-		Out(GAK);	//"GAK="
-		SendData(b + 49);
-		SendData(c + 49);
-		SendData(e + 49);
-		goto end;
-	} else if (PartFound == PART_TRIAC) {
-		Out(Triac);	//"Triac"
-		SetLine(1); //2. Zeile
-		Out(Gate);
-		SendData(b + 49);
-		Out(A1);		//";A1="
-		SendData(e + 49);
-		Out(A2);		//";A2="
-		SendData(c + 49);
-		goto end;
-		} else if(PartFound == PART_RESISTOR) {
-			Out(Resistor); //"Widerstand: "
-			SendData(ra + 49);	//Pin-Angaben
-			SendData('-');
-			SendData(rb + 49);
-			SetLine(1); //2. Zeile
-			if(rv[0]>512) {		//Uberprufen, wie weit die an den Testwiderstanden anliegenden Spannungen von 512 abweichen
-				hfe[0] = (rv[0] - 512);
-			} else {
-				hfe[0] = (512 - rv[0]);
-			}
-			if(rv[1]>512) {
-				hfe[1] = (rv[1] - 512);
-			} else {
-				hfe[1] = (512 - rv[1]);
-			}
-			if(hfe[0] > hfe[1])  {
-				radcmax[0] = radcmax[1];
-				rv[0] = rv[1];	//Ergebnis verwenden, welches naher an 512 liegt (bessere Genauigkeit)
-				rv[1] = rhval;	//470k-Testwiderstand	
-			} else {
-				rv[1] = rlval;	//680R-Testwiderstand
-			}
-			if(rv[0]==0) rv[0] = 1;
-			lhfe = (unsigned long)((unsigned long)((unsigned long)rv[1] * (unsigned long)rv[0]) / (unsigned long)((unsigned long)radcmax[0] - (unsigned long)rv[0]));	//Widerstand berechnen
-			itoa(lhfe,outval);
-
-			if(rv[1]==rhval) {	//470k-Widerstand?
-				char *tmpS = outval;
-				ra = 0;
-				while(*tmpS++)
-					ra++;
-					
-				//ra = strlen(outval);	//Notig, um Komma anzuzeigen
-				for(rb=0;rb<ra;rb++) {
-					SendData(outval[rb]);
-					if(rb==(ra-2)) SendData('.');	//Komma
-				}
-				SendData ('k'); //Kilo-Ohm, falls 470k-Widerstand verwendet
-			} else {
-				Out(outval);
-			}
-			Out("Ohm");
-			//lcd_data(LCD_CHAR_OMEGA);	//Omega fur Ohm 
-			goto end;
-/*TODO
-		} else if(PartFound == PART_CAPACITOR) {	//Kapazitatsmessung auch nur auf Mega8 verfugbar
-			lcd_eep_string(Capacitor);
-			lcd_data(ca + 49);	//Pin-Angaben
-			lcd_data('-');
-			lcd_data(cb + 49);
-			Line2(); //2. Zeile
-			tmpval2 = 'n';
-			if(cv > 99999) {	//ab 1F
-				cv /= 1000;
-				tmpval2 = LCD_CHAR_U;
-			}
-			ultoa(cv, outval, 10);
-			tmpval = strlen(outval);
-			lcd_show_format_cap(outval, tmpval, tmpval);
-			lcd_data(tmpval2);
-			lcd_data('F');
-			goto end;
-	#endif*/
-	}
-//	#ifdef UseM8	//Unterscheidung, ob Dioden gefunden wurden oder nicht nur auf Mega8
-		if(NumOfDiodes == 0) {
-			//Keine Dioden gefunden
-			Out(TestFailed1); //"Kein,unbek. oder"
-			SetLine(1); //2. Zeile
-			Out(TestFailed2); //"defektes "
-			Out(Bauteil);
-		} else {
-			Out(Bauteil);
-			Out(Unknown); //" unbek."
-			SetLine(1); //2. Zeile
-			Out(OrBroken); //"oder defekt"
-			SendData(NumOfDiodes + 48);
-			SendData('D');//lcd_data(LCD_CHAR_DIODE);
-		}
-//	#endif
-	end:
-
-////////////////////////////////////
-	while(1)
-	{
-//		value = ReadAdc(7);
-//		itoa(value, v);
-//		Outline(0, "                ");
-//		Outline(0, v);
-//		delay(MS(50));
-		;
-	}
-}
-
-void DischargePin(uint8_t PinToDischarge, uint8_t DischargeDirection) 
-{
-	/*
-Connecting a component short (10 ms) set to a particular potential
-This function is provided for discharging of MOSFET gate to protect diodes u.. MOSFETs to recognize knnen
-Parameters:
-Pinto discharge: to be unloaded pin
-Discharge direction: 0 = to ground (N-channel FET), 1 = to positive (P-channel FET)
-*/
-	uint8_t tmpval;
-	tmpval = (PinToDischarge * 2 + 1);		//ntig wegen der Anordnung der Widerstnde
-
-	GPIOC->DDR |= (1<<tmpval);			//Pin auf Ausgang und ber R_L auf Masse
-
-	if(DischargeDirection)
-	{
-		GPIOC->ODR |= (1 << tmpval);			//R_L aus
-	}
-		
-	delay(MS(10));
-	GPIOC->DDR &= ~(1<<tmpval);			//Pin wieder auf Eingang
-	if(DischargeDirection) 
-		GPIOC->ODR &= ~(1<<tmpval);			//R_L aus
-}
-/*
-Function to test the properties of the component at the specified pin assignment
-Parameters:
-HighPin: pin, which is initially set to positive potential
-LowPin: pin, which is initially set at a negative potential
-TristatePin: pin, which is initially left open
-
-During testing TristatePin is switched course, also have a positive or negative.
-*/
-/*
-HighPin is placed firmly on Vcc
-LowPin is placed over R_L to GND
-TristatePin is switched to highZ	
-*/
-
-void CheckPins(uint8_t HighPin, uint8_t LowPin, uint8_t TristatePin) {
-	unsigned int adcv[6];
-	uint8_t tmpval, tmpval2;
-	//TODO wdt_reset();
-	//Pins setzen
-	tmpval = (LowPin * 2 + 1);
-	GPIOC->DDR = (1 << tmpval);//Low-pin to output and to ground via R_L
-	GPIOC->CR1 = (1 << tmpval);//!!! all others - HiZ
-	GPIOC->ODR = 0;
-	GPIOB->DDR = (1 << HighPin);
-	GPIOB->CR1 = (1 << HighPin);//!!! all others - HiZ
-	GPIOB->ODR = (1 << HighPin);////High-pin to output and Vcc
-	delay(MS(5));
-	//Some MOSFETs must be the gate (TristatePin) first discharge
-	//N-Kanal:
-	DischargePin(TristatePin,0);
-	//voltage at Low-pin determined
-	adcv[0] = ReadADC(LowPin);
-	if(adcv[0] < 200) goto next;	//Locks the device now?
-	//else: Unload for P-channel (gate to plus)
-	DischargePin(TristatePin,1);
-	//voltage at Low-pin determined
-	adcv[0] = ReadADC(LowPin);
-
-	next:
-
-	if(adcv[0] > 19) {//Bauteil leitet ohne Steuerstrom etwas
-		//Test on N-JFET, or even conducting N-MOSFET
-		GPIOC->DDR |= (2<<(TristatePin*2 + 1));//Tristate Pin (suspected Gate) via R_H to ground
-		GPIOC->CR1 |= (2<<(TristatePin*2 + 1));//!!!
-		delay(MS(20));
-		adcv[1] = ReadADC(LowPin);		//Measure voltage at the suspected source
-		GPIOC->ODR |= (2<<(TristatePin*2 + 1)); //Tristate Pin (suspected Gate) via R_H to Plus
-		delay(MS(20));
-		adcv[2] = ReadADC(LowPin);		//Measure voltage at the suspected source
-		//If it is a normally on MOSFET or JFET has adcv[1]> adcv[0]
-		if(adcv[2]>(adcv[1]+100)) {
-			//Measure voltage at the gate, to distinguish between the MOSFET and JFET
-			GPIOB->ODR = 0;
-			GPIOB->DDR = (1 << LowPin);//Low-Pin sets to ground
-			GPIOB->CR1 = (1 << LowPin);//!!! all others to HiZ
-			tmpval = (HighPin * 2 + 1);
-			GPIOC->DDR |= (1 << tmpval);
-			GPIOC->CR1 |= (1 << tmpval);//!!!
-			GPIOC->ODR |= (1 << tmpval);//High-Pin output with R_L to Vcc
-			delay(MS(20));
-			adcv[2] = ReadADC(TristatePin);		//Measure voltage at the suspected gate
-			if(adcv[2]>800) {	//MOSFET
-				PartFound = PART_FET;			//N-Kanal-MOSFET
-				PartMode = PART_MODE_N_D_MOS;	//Verarmungs-MOSFET
-			} else {	//JFET (pn-Ubergang zwischen G und S leitet)
-				PartFound = PART_FET;			//N-Kanal-JFET
-				PartMode = PART_MODE_N_JFET;
-			}
-			b = TristatePin;
-			c = HighPin;
-			e = LowPin;
-		}
-		
-		//Test for P-JFET, or even conducting P-MOSFET
-		//Low-Pin (suspected drain) firmly on earth, tri-pin (suspected Gate) is still about to R_H Plus
-		GPIOB->ODR = 0;
-		GPIOB->CR1 = (1 << LowPin);//!!! all others to HiZ
-		GPIOB->DDR = (1 << LowPin);
-		tmpval = (HighPin * 2 + 1);
-		GPIOC->DDR |= (1 << tmpval);
-		GPIOC->CR1 |= (1 << tmpval);//!!!
-		GPIOC->ODR |= (1 << tmpval); //High-pin to Vcc via R_L
-		delay(MS(20));
-		adcv[1] = ReadADC(HighPin);		//Measure voltage at the suspected source
-		GPIOC->ODR = (1 << tmpval);  //Tristate Pin (suspected Gate) via R_H to ground
-		delay(MS(20));
-		adcv[2] = ReadADC(HighPin);		//Measure voltage at the suspected source
-		//If it is a normally on MOSFET P-or P-JFET, had adcv [0]> adcv [1] are
-		if(adcv[1]>(adcv[2]+100)) {
-			//Measure voltage at the gate, to distinguish between the MOSFET and JFET
-			GPIOB->ODR = (1 << HighPin);
-			GPIOB->CR1 = (1 << HighPin);//!!! all others to HiZ
-			GPIOB->DDR = (1 << HighPin);//High-pin firmly Plus
-			delay(MS(20));
-			adcv[2] = ReadADC(TristatePin);		//Voltage at the gate suspected measure
-			if(adcv[2]<200) {	//MOSFET
-				PartFound = PART_FET;			//P-Kanal-MOSFET
-				PartMode = PART_MODE_P_D_MOS;	//Verarmungs-MOSFET
-			} else {	//JFET (pn-Ubergang zwischen G und S leitet)
-				PartFound = PART_FET;			//P-Kanal-JFET
-				PartMode = PART_MODE_P_JFET;
-			}
-			b = TristatePin;
-			c = LowPin;
-			e = HighPin;
-		}
-	}
-	//Pins erneut setzen
-	tmpval = (LowPin * 2 + 1);
-	GPIOC->DDR = (1 << tmpval);
-	GPIOC->CR1 = (1 << tmpval); //!!! all others to HiZ
-	GPIOC->ODR = 0;//Low-Pin auf Ausgang und uber R_L auf Masse
-	GPIOB->DDR = (1 << HighPin);
-	GPIOB->CR1 = (1 << HighPin);// !!!
-	GPIOB->ODR = (1 << HighPin);//High-Pin fest auf Vcc
-	delay(MS(5));
-	
-	if(adcv[0] < 200) {	//If the component is no continuity between HighPin and has LowPin
-		//Test auf pnp
-		tmpval2 = (TristatePin * 2 + 1);
-		GPIOC->DDR |= (1 << tmpval2);//Tristate-Pin uber R_L auf Masse, zum Test auf pnp
-		GPIOC->CR1 |= (1 << tmpval2);//!!!
-		delay(MS(2));
-		adcv[1] = ReadADC(LowPin);		//Spannung messen
-		if(adcv[1] > 700) {
-			//Bauteil leitet => pnp-Transistor o.a.
-			//Gain factor measured in both directions
-			GPIOC->DDR = (1 << tmpval);
-			GPIOC->CR1 = (1 << tmpval);
-			tmpval2++;
-			GPIOC->DDR |= (1 << tmpval2);
-			GPIOC->CR1 |= (1 << tmpval2);
-			delay(MS(10));
-			adcv[1] = ReadADC(LowPin);		//Low voltage on the pin (assumed collector) measure
-			adcv[2] = ReadADC(TristatePin);	//Base voltage measure
-			//Prooven if test already run times
-			if((PartFound == PART_TRANSISTOR) || (PartFound == PART_FET)) PartReady = 1;
-			hfe[PartReady] = adcv[1];
-			uBE[PartReady] = adcv[2];
-
-			if(PartFound != PART_THYRISTOR) {
-				if(adcv[2] > 200) {
-					PartFound = PART_TRANSISTOR;	//PNP transistor found (base is "up" solid)
-					PartMode = PART_MODE_PNP;
-				} else {
-					if(adcv[0] < 20) {	//Forward voltage in the off state is low enough? (otherwise D-mode FETs are mistakenly identified as E-mode)
-					 	PartFound = PART_FET;			//P-channel MOSFET found (base / gate is not pulled "up")
-						PartMode = PART_MODE_P_E_MOS;
-						//Measurement of the gate threshold voltage
-						gthvoltage = 0;
-/*TODO!!!		tmpval = (1<<LowPin);
-						tmpval2 = R_DDR;
-						ADMUX = TristatePin | (1<<REFS0);
-						for(b=0;b<13;b++) {
-							wdt_reset();
-							DischargePin(TristatePin,1);
-							while (!(ADC_PIN&tmpval));  // Warten, bis der MOSFET schaltet und Drain auf high geht
-							R_DDR = 0;
-							ADCSRA |= (1<<ADSC);
-							while (ADCSRA&(1<<ADSC));
-							gthvoltage += (1023 - ADCW);
-							R_DDR = tmpval2;
-						}
-						gthvoltage *= 3;	//Umrechnung in mV, zusammen mit der Division durch 8 (bei der LCD-Anzeige)*/
-					}
-				}
-				b = TristatePin;
-				c = LowPin;
-				e = HighPin;
-			}
-		}
-
-		//Tristate (assumed basis) Plus, for testing on an npn
-		GPIOB->ODR = 0;  //Low-Pin fest auf Masse
-		tmpval = (TristatePin * 2 + 1);
-		tmpval2 = (HighPin * 2 + 1);
-		GPIOC->DDR = (1 << tmpval) | (1 << tmpval2);
-		GPIOC->CR1 = (1 << tmpval) | (1 << tmpval2);
-		GPIOC->ODR = (1 << tmpval) | (1 << tmpval2);//High-Pin und Tristate-Pin uber R_L auf Vcc
-		GPIOB->DDR = (1 << LowPin);
-		GPIOB->CR1 = (1 << LowPin);
-		delay(MS(10));
-		adcv[1] = ReadADC(HighPin);		//Spannung am High-Pin messen
-		if(adcv[1] < 500) {
-			if(PartReady==1) goto testend;
-			//Bauteil leitet => npn-Transistor o.a.
-
-			//Test auf Thyristor:
-			//Gate entladen
-			
-			GPIOC->ODR = (1 << tmpval2);			//Tristate-Pin (Gate) uber R_L auf Masse
-			GPIOC->CR1 = (1 << tmpval2);
-			delay(MS(10));
-			GPIOC->DDR = (1 << tmpval2);			//Tristate-Pin (Gate) hochohmig
-			//Test auf Thyristor
-			delay(MS(5));
-			adcv[3] = ReadADC(HighPin);		//Spannung am High-Pin (vermutete Anode) erneut messen
-			
-			GPIOC->ODR = 0;						//High-Pin (vermutete Anode) auf Masse
-			delay(MS(5));
-			GPIOC->ODR = (1 << tmpval2);			//High-Pin (vermutete Anode) wieder auf Plus
-			delay(MS(5));
-			adcv[2] = ReadADC(HighPin);		//Spannung am High-Pin (vermutete Anode) erneut messen
-			if((adcv[3] < 500) && (adcv[2] > 900)) {	//Nach Abschalten des Haltestroms muss der Thyristor sperren
-				//war vor Abschaltung des Triggerstroms geschaltet und ist immer noch geschaltet obwohl Gate aus => Thyristor
-				uint16_t tmpAdc;
-				PartFound = PART_THYRISTOR;
-				//Test auf Triac
-				GPIOC->DDR = 0;
-				GPIOC->CR1 = 0;
-				GPIOC->ODR = 0;
-				GPIOB->ODR = (1 << LowPin);	//Low-Pin fest auf Plus
-				GPIOB->CR1 = (1 << LowPin);
-				delay(MS(5));
-				GPIOC->DDR = (1 << tmpval2);	//HighPin uber R_L auf Masse
-				GPIOC->CR1 = (1 << tmpval2);
-				delay(MS(5));
-				tmpAdc = ReadADC(HighPin);
-				if(tmpAdc > 50) goto savenresult;	//Spannung am High-Pin (vermuteter A2) messen; falls zu hoch: Bauteil leitet jetzt => kein Triac
-				GPIOC->DDR |= (1 << tmpval);	//Gate auch uber R_L auf Masse => Triac musste zunden
-				GPIOC->CR1 |= (1 << tmpval);
-				delay(MS(5));
-				tmpAdc = ReadADC(TristatePin);
-				if(tmpAdc < 200) goto savenresult; //Spannung am Tristate-Pin (vermutetes Gate) messen; Abbruch falls Spannung zu gering
-				tmpAdc = ReadADC(HighPin);
-				if(tmpAdc < 150) goto savenresult; //Bauteil leitet jetzt nicht => kein Triac => Abbruch
-				GPIOC->DDR = (1 << tmpval2);	//TristatePin (Gate) wieder hochohmig
-				GPIOC->CR1 = (1 << tmpval2);
-				delay(MS(5));
-				tmpAdc = ReadADC(HighPin);
-				if(tmpAdc < 150) goto savenresult; //Bauteil leitet nach Abschalten des Gatestroms nicht mehr=> kein Triac => Abbruch
-				GPIOC->ODR = (1 << tmpval2);	//HighPin uber R_L auf Plus => Haltestrom aus
-				delay(MS(5));
-				GPIOC->ODR = 0;				//HighPin R_L over again on earth; Triac now had to block
-				delay(MS(5));
-				tmpAdc = ReadADC(HighPin);
-				if(tmpAdc > 50) goto savenresult;	//Spannung am High-Pin (vermuteter A2) messen; falls zu hoch: Bauteil leitet jetzt => kein Triac
-				PartFound = PART_TRIAC;
-				PartReady = 1;
-				goto savenresult;
-			}
-			//Test auf Transistor oder MOSFET
-			tmpval++;
-			GPIOC->DDR |= (1 << tmpval);		//Tristate-Pin (Basis) auf Ausgang
-			GPIOC->CR1 |= (1 << tmpval);
-			GPIOC->ODR |= (1 << tmpval);		//Tristate-Pin (Basis) uber R_H auf Plus
-			delay(MS(50));
-			adcv[1] = ReadADC(HighPin);		//Spannung am High-Pin (vermuteter Kollektor) messen
-			adcv[2] = ReadADC(TristatePin);	//Basisspannung messen
-
-			if((PartFound == PART_TRANSISTOR) || (PartFound == PART_FET)) PartReady = 1;	//prufen, ob Test schon mal gelaufen
-			hfe[PartReady] = 1023 - adcv[1];
-			uBE[PartReady] = 1023 - adcv[2];
-			if(adcv[2] < 500) {
-				PartFound = PART_TRANSISTOR;	//NPN-Transistor gefunden (Basis wird "nach unten" gezogen)
-				PartMode = PART_MODE_NPN;
-			} else {
-				if(adcv[0] < 20) {	//Durchlassspannung im gesperrten Zustand gering genug? (sonst werden D-Mode-FETs falschlicherweise als E-Mode erkannt)
-					PartFound = PART_FET;			//N-Kanal-MOSFET gefunden (Basis/Gate wird NICHT "nach unten" gezogen)
-					PartMode = PART_MODE_N_E_MOS;
-					//Gate-Schwellspannung messen
-					gthvoltage = 0;
-/* TODO		tmpval2 = GPIOC->DDR;
-					tmpval=(1<<HighPin);
-					ADMUX = TristatePin | (1<<REFS0);
-					for(b=0;b<13;b++) {
-						wdt_reset();
-						DischargePin(TristatePin,0);
-						while ((ADC_PIN&tmpval));  // Warten, bis der MOSFET schaltet und Drain auf low geht
-						R_DDR = 0;
-						R_PORT = 0;
-						ADCSRA |= (1<<ADSC);
-						while (ADCSRA&(1<<ADSC));
-						gthvoltage += ADCW;
-						R_DDR = tmpval2;
-						R_PORT = tmpval2;
-					}
-					gthvoltage *= 3;	//Umrechnung in mV, zusammen mit der Division durch 8 (bei der LCD-Anzeige)
-					*/
-				}
-			}
-			savenresult:
-			b = TristatePin;
-			c = HighPin;
-			e = LowPin;
-		}
-		GPIOB->DDR = 0;
-		GPIOB->CR1 = 0;
-		GPIOB->ODR = 0;
-		//Fertig
-	} else {	//Durchgang
-		//Test auf Diode
-		tmpval2 = (2<<(2*HighPin + 1));	//R_H
-		tmpval = (1<<(2*HighPin + 1));	//R_L
-		GPIOB->ODR = 0;
-		GPIOB->CR1 = (1 << LowPin);
-		GPIOB->DDR = (1 << LowPin);	//Low-Pin fest auf Masse, High-Pin ist noch uber R_L auf Vcc
-		DischargePin(TristatePin,1);	//Entladen fur P-Kanal-MOSFET
-		delay(MS(5));
-		adcv[0] = ReadADC(HighPin);// - ReadADC(LowPin);
-		GPIOC->DDR = tmpval2;	//High-Pin uber R_H auf Plus
-		GPIOC->CR1 = tmpval2;
-		GPIOC->ODR = tmpval2;
-		delay(MS(5));
-		adcv[2] = ReadADC(HighPin);// - ReadADC(LowPin);
-		GPIOC->DDR = tmpval;	//High-Pin uber R_L auf Plus
-		GPIOC->CR1 = tmpval;
-		GPIOC->ODR = tmpval;
-		DischargePin(TristatePin,0);	//Entladen fur N-Kanal-MOSFET
-		delay(MS(5));
-		adcv[1] = ReadADC(HighPin);// - ReadADC(LowPin);
-		GPIOC->DDR = tmpval2;	//High-Pin uber R_H  auf Plus
-		GPIOC->CR1 = tmpval2;
-		GPIOC->ODR = tmpval2;
-		delay(MS(5));
-		adcv[3] = ReadADC(HighPin);// - ReadADC(LowPin);
-		/*Without unloading can cause false detections, because the gate of a MOSFET can still be charged.
-The additional measurement with the "big" resistance R_H is carried out to anti-parallel diode of
-Resistors to be able to distinguish.
-A diode has a forward current of relatively independent Durchlassspg.
-If the resistance is the voltage drop changes significantly (linear) with the flow.
-		*/
-		if(adcv[0] > adcv[1]) {
-			adcv[1] = adcv[0];	//the higher value wins
-			adcv[3] = adcv[2];
-		}
-
-		if((adcv[1] > 30) && (adcv[1] < 950)) { //Spannung liegt uber 0,15V und unter 4,64V => Ok
-			uint8_t i,j;
-			if((PartFound == PART_NONE) || (PartFound == PART_RESISTOR)) PartFound = PART_DIODE;	//Diode nur angeben, wenn noch kein anderes Bauteil gefunden wurde. Sonst gabe es Probleme bei Transistoren mit Schutzdiode
-			diodes[NumOfDiodes].Anode = HighPin;
-			diodes[NumOfDiodes].Cathode = LowPin;
-			diodes[NumOfDiodes].Voltage = (adcv[1]*54/11);	// ca. mit 4,9 multiplizieren, um aus dem ADC-Wert die Spannung in Millivolt zu erhalten
-			NumOfDiodes++;
-			for(i=0;i<NumOfDiodes;i++) {
-				if((diodes[i].Anode == LowPin) && (diodes[i].Cathode == HighPin)) {	//zwei antiparallele Dioden: Defekt oder Duo-LED
-					if((adcv[3]*64) < (adcv[1] / 5)) {	//Durchlassspannung fallt bei geringerem Teststrom stark ab => Defekt
-						if(i<NumOfDiodes) {
-							for(j=i;j<(NumOfDiodes-1);j++) {
-								diodes[j].Anode = diodes[j+1].Anode;
-								diodes[j].Cathode = diodes[j+1].Cathode;
-								diodes[j].Voltage = diodes[j+1].Voltage;
-							}
-						}
-						NumOfDiodes -= 2;
-					}
-				}
-			}
-		}
-	}
-
-	#if 0
-	//def UseM8	//Widerstandsmessung nur auf dem Mega8 verfugbar
-		//Test auf Widerstand
-		tmpval2 = (2<<(2*HighPin));	//R_H
-		tmpval = (1<<(2*HighPin));	//R_L
-		ADC_PORT = TXD_VAL;
-		ADC_DDR = (1<<LowPin) | (1<<TxD);	//Low-Pin fest auf Masse
-		R_DDR = tmpval;	//High-Pin uber R_L auf Plus
-		R_PORT = tmpval;
-		adcv[2] = ReadADC(LowPin);
-		adcv[0] = ReadADC(HighPin) - adcv[2];
-		R_DDR = tmpval2;	//High-Pin uber R_H auf Plus
-		R_PORT = tmpval2;
-		adcv[3] = ReadADC(LowPin);
-		adcv[1] = ReadADC(HighPin) - adcv[3];
-
-		//Messung der Spannungsdifferenz zwischen dem Pluspol von R_L und R_H und Vcc
-		tmpval2 = (2<<(2*LowPin));	//R_H
-		tmpval = (1<<(2*LowPin));	//R_L
-		ADC_DDR = (1<<HighPin) | (1<<TxD);		//High-Pin auf Ausgang
-		ADC_PORT = (1<<HighPin) | TXD_VAL;	//High-Pin fest auf Plus
-		R_PORT = 0;
-		R_DDR = tmpval;				//Low-Pin uber R_L auf Masse
-		adcv[2] += (1023 - ReadADC(HighPin));
-		R_DDR = tmpval2;				//Low-Pin uber R_H auf Masse
-		adcv[3] += (1023 - ReadADC(HighPin));
-		
-		if(((adcv[0] - adcv[2]) < 900) && ((adcv[1] - adcv[3]) > 20)) goto testend; 	//Spannung fallt bei geringem Teststrom nicht weit genug ab
-		if(((adcv[1] * 32) / 31) < adcv[0]) {	//Abfallende Spannung fallt bei geringerem Teststrom stark ab und es besteht kein "Beinahe-Kurzschluss" => Widerstand
-			if((PartFound == PART_DIODE) || (PartFound == PART_NONE) || (PartFound == PART_RESISTOR)) {
-				if((tmpPartFound == PART_RESISTOR) && (ra == LowPin) && (rb == HighPin)) {*/
-					/* Das Bauteil wurde schon einmal mit umgekehrter Polaritat getestet.
-					Jetzt beide Ergebnisse miteinander vergleichen. Wenn sie recht ahnlich sind,
-					handelt es sich (hochstwahrscheinlich) um einen Widerstand. */
-					if(!((((adcv[0] + 100) * 6) >= ((rv[0] + 100) * 5)) && (((rv[0] + 100) * 6) >= ((adcv[0] + 100) * 5)) && (((adcv[1] + 100) * 6) >= ((rv[1] + 100) * 5)) && (((rv[1] + 100) * 6) >= ((adcv[1] + 100) * 5)))) {
-						//min. 20% Abweichung => kein Widerstand
-						tmpPartFound = PART_NONE;
-						goto testend;
-					}
-					PartFound = PART_RESISTOR;
-				}
-				rv[0] = adcv[0];
-				rv[1] = adcv[1];
-
-				radcmax[0] = 1023 - adcv[2];	//Spannung am Low-Pin ist nicht ganz Null, sondern rund 0,1V (wird aber gemessen). Der dadurch entstehende Fehler wird hier kompenisert
-				radcmax[1] = 1023 - adcv[3];
-				ra = HighPin;
-				rb = LowPin;
-				tmpPartFound = PART_RESISTOR;
-			}
-		}
-	#endif
-	testend:
-	GPIOB->DDR = 0;
-	GPIOB->CR1 = 0;
-	GPIOB->ODR = 0;
-	GPIOC->DDR = 0;
-	GPIOC->CR1 = 0;
-	GPIOC->ODR = 0;
-}
-
-#ifdef USE_FULL_ASSERT
-void assert_failed(uint8_t* file, uint32_t line)
-{ 
-  while (1)
-  {
-  }
-}
-#endif
+#include "stm8s.h"
+#include "stm8s_adc1.h"
+#include "stm8s_clk.h"
+#include "delay.h"
+#include "HD44780.h"
+#include "adc.h"
+#include "tester.h"
+#include "socket.h"
+#include "fixmath.h"
+#include "profile.h"
+#include "watchdog.h"
+#include "trace.h"
+#include "match.h"
+#include "curve.h"
+#include "strtab.h"
+#include "text.h"
+
+//pins C1-C6 - digital probes
+//pins B0, B1, B2 - analog testpoints (adc.h)
+
+/* Settings for capacitance measurement (for ATMega8 interesting)
+The test of whether there is a capacitor takes a relatively long time, with more than 50 ms per test procedure is expected to
+In all six possible test events is an extension of the test period by about 0.3 s to 0.5 s.
+With CAP_TEST_MODE used to set the tests.
+
+Meanings of the bits (7 = MSB):
+7:6 not used
+
+5-4 Test Mode
+00: capacitor measurement disabled
+01: capacitor measurement for an adjustable pin combination (both ways), extended testing time by about 200ms 120th ..
+10: capacitor measurement for every 6-pin combinations, extended test times by about 300 .. 500ms
+
+3:2 The first pin of the pin-selected combination (0 .. 2), only decisive when bits 5:4 = 01
+
+1-0 second pin of the pin-selected combination (0 .. 2), only important when bits 5:4 = 01
+*/
+uint8_t ctmode = 0b00100010; // measure for all 6-pin combinations
+
+/*
+Exact values of the resistors used in ohms.
+The nominal value for R_L is 680 ohms, for 470kOhm R_H
+The program for deviations from these values (eg due to component tolerances)
+To calibrate, enter the resistor values in ohms in the following defines:
+*/
+const	unsigned int rlval = RL_OHM;		//R_L; Normwert 680 Ohm (Wert in fixmath.h)
+const	unsigned int rhval = RH_100;		//R_H; Normwert 470000 Ohm, durch 100 dividiert angeben (Wert in fixmath.h)
+
+/*
+Factors for Kapatitatsmessung with capacitors
+These factors depend on manufacturing tolerances from the AVR and thus have to be adjusted, if necessary
+H_CAPACITY_FACTOR for the test with 470k resistor (low capacity)
+L_CAPACITY_FACTOR for the measurement with 680-ohm resistor (high capacity)
+The entire range is about 0.2 nF to 7300?F.
+*/
+const	unsigned int H_CAPACITY_FACTOR = 394;
+const	unsigned int L_CAPACITY_FACTOR = 283;
+
+const	char TestRunning[]  = "Testing ...";	//StartLcd braucht den Text im Klartext, die ubrigen in strings.txt
+const	unsigned char CurrentPrefix[]  = {'n', GLYPH_MICRO, 'm'};
+
+/*
+Converts the result of ReadADCLong (voltage over R_H) to a current in nA:
+I = ADC/16 * 5V/1023 / (rhval*100) = ADC * 3055 / rhval [nA]
+The maximum is about 10.6 uA, bigger currents are no leakage any more.
+*/
+unsigned int LeakageCurrent(uint16_t adc16)
+{
+	return FixMul(adc16, Q_NA_LEAK);
+}
+
+/*
+Auswertung der beiden Messpunkte einer Diode: adcl mit R_L (einige mA), adch mit R_H (einige uA).
+Aus U = n * UT * ln(I/Is) folgt mit dU = UL - UH und dem Stromverhaltnis r = IL/IH:
+n = dU / (UT * ln r) und rd = n * UT / IL = dU / (ln r * IL)
+Mit UT = 25,85mV und ln r = log2(r) * 0,693 (L = log2(r) * 16):
+n * 10 = dU[mV] * 125 / (14 * L), rd = dU[mV] * 23084 / (L * IL[uA])
+Die Einordnung als LED erfolgt uber die Durchlassspannung; Z-Dioden unter 4,6V
+haben einen weichen Knick, also einen deutlich hoheren scheinbaren Idealitatsfaktor.
+*/
+void DiodeKind(struct Diode *d);
+
+void ClassifyDiode(struct Diode *d, unsigned int adcl, unsigned int adch)
+{
+	unsigned long il, ih;
+	unsigned int l, n;
+	int du;
+
+	d->Voltage = AdcToMv(adcl);
+	du = d->Voltage - (int)AdcToMv(adch);
+	il = AdcToUaRL(1023 - adcl);	//uA
+	ih = AdcToNaRH(1023 - adch);	//nA
+	d->Ideality = 0;
+	d->Rd = 0;
+
+	if((du > 0) && (ih > 0) && ((il * 1000) > (ih * 2))) {
+		l = Log2Q4((il * 1000) / ih);
+		n = (unsigned int)(((unsigned long)du * 125) / (14 * l));
+		d->Ideality = (n > 255) ? 255 : n;
+		d->Rd = (unsigned int)(((unsigned long)du * 23084) / ((unsigned long)l * il));
+	}
+
+	DiodeKind(d);
+}
+
+//Art der Diode aus Durchlassspannung und Idealitatsfaktor
+void DiodeKind(struct Diode *d)
+{
+	d->Kind = DIODE_PLAIN;
+	if(d->Voltage < 1000) return;		//Si, Schottky, Germanium
+	if(d->Ideality > ZENER_IDEALITY) {
+		d->Kind = DIODE_ZENER;
+	} else if(d->Voltage < 1550) {
+		d->Kind = DIODE_LED_IR;
+	} else if(d->Voltage < 2050) {
+		d->Kind = DIODE_LED_RED;		//auch orange, gelb
+	} else if(d->Voltage < 2600) {
+		d->Kind = DIODE_LED_GREEN;
+	} else if(d->Voltage < 2950) {
+		d->Kind = DIODE_LED_BLUE;
+	} else {
+		d->Kind = DIODE_LED_WHITE;
+	}
+}
+
+#if TEST_NETWORK
+/*
+Diode mit Serienwiderstand (z.B. LED mit Vorwiderstand) aus drei Messpunkten:
+I1 mit R_L (Low-Pin fest auf Masse, adcl/ofsl), I2 mit R_L an beiden Pins (etwa
+halber Strom, h2/l2), I3 mit R_H (adch). Modell U = Uj + k * L + I * Rs, L = log2(I) * 16.
+Aus d1 = U1 - U2 = k * L1 + (I1 - I2) * Rs und d2 = U2 - U3 = k * L2 + I2 * Rs
+(I3 gegen I2 vernachlassigt) folgt
+Rs = (d1 * L2 - d2 * L1) / ((I1 - I2) * L2 - I2 * L1)
+L1 ist klein (I1/I2 < 2,5), daher mit 6 Nachkommabits uber ln r = 2 * (z + z^3 / 3),
+z = (I1 - I2) / (I1 + I2); Rs in 8-Ohm-Schritten, damit alles in 32 Bit bleibt.
+Der Fit gilt nur mit einem plausiblen Idealitatsfaktor (1 .. ZENER_IDEALITY) fur k.
+*/
+void FitSeries(struct Diode *d, unsigned int adcl, unsigned int ofsl, unsigned int adch, uint16_t h2, uint16_t l2)
+{
+	unsigned long i1, i2, i3, z;
+	unsigned int l1, l3;
+	long d1, d2, den, rs, n;
+
+	d->Rs = 0;
+	if(h2 <= l2) return;
+	i1 = AdcToUaRL(1023 - adcl - ofsl);	//uA
+	i2 = AdcToUaRL(l2);					//uA, Strom durch R_L am Low-Pin
+	i3 = AdcToNaRH(1023 - adch);		//nA
+	if((i2 == 0) || (i3 == 0) || (i1 <= i2)) return;
+	z = ((i1 - i2) << 12) / (i1 + i2);	//Q12
+	l1 = (unsigned int)((185 * (z + ((((z * z) >> 12) * z) >> 12) / 3)) >> 12);	//log2(I1/I2) * 64
+	l3 = Log2Q4((i2 * 1000) / i3) * 4;	//log2(I2/I3) * 64
+	d1 = (long)AdcToMv(adcl) - (long)AdcToMv(h2 - l2);
+	d2 = (long)AdcToMv(h2 - l2) - (long)AdcToMv(adch);
+	den = (long)(i1 - i2) * l3 - (long)i2 * l1;
+	if(den <= 0) return;
+	rs = (((d1 * l3 - d2 * l1) * 125) / den) * 8;	//mV/uA = kOhm
+	if((rs < NET_RS_MIN) || (rs > 65535)) return;
+	n = ((d2 - (long)((i2 * rs) / 1000)) * 500) / (14 * (long)l3);	//n * 10 ohne Rs, l3 in Q6
+	if((n < 10) || (n > ZENER_IDEALITY)) return;
+	d->Rs = (unsigned int)rs;
+	d->Uj = d->Voltage - (int)((i1 * rs) / 1000);
+}
+#endif
+
+
+void CheckPins(TestContext *tc, uint8_t HighPin, uint8_t LowPin, uint8_t TristatePin);
+void DischargePin(uint8_t PinToDischarge, uint8_t DischargeDirection);
+uint8_t DischargeAll(uint16_t *start, uint16_t MaxMs);
+void lcd_show_format_cap(char outval[], uint8_t strlength, uint8_t CommaPos);
+void ReadCapacity(uint8_t HighPin, uint8_t LowPin);		//Kapazitatsmessung nur auf Mega8 verfugbar
+void lcd_show_current(unsigned int val, uint8_t prefix);
+unsigned int GateThreshold(uint8_t Gate, uint8_t Drain, uint8_t PChannel);
+void ReadDepletionFET(TestContext *tc, uint8_t Gate, uint8_t Drain, uint8_t Source);
+void ReadThyristor(TestContext *tc, uint8_t Gate, uint8_t Anode, uint8_t Cathode);
+void ReadFollower(TestContext *tc, uint8_t Base, uint8_t Collector, uint8_t Emitter);
+void FollowerGain(TestContext *tc);
+void ReadRecovery(TestContext *tc);
+void lcd_show_gate(const TestContext *tc);
+uint8_t ShowResult(const TestContext *tc);
+void TestPart(TestContext *tc);
+void ProbePart(TestContext *tc);
+void MeasurePart(TestContext *tc);
+void ScanSockets(void);
+void ShortPins(uint8_t p, uint8_t q);
+uint8_t PreCheck(TestContext *tc);
+void FitNetwork(TestContext *tc);
+void ResistorValue(TestContext *tc);
+void ReadRC(TestContext *tc, uint8_t HighPin, uint8_t LowPin, unsigned int *adcv);
+
+#define CUR_NA 0	//Stromangabe in nA
+#define CUR_UA 1	//Stromangabe in uA
+
+void itoa(uint32_t v, char *buf)
+{
+	char tmp[17];
+	int8_t i = 0;
+	
+	while(v != 0)
+	{
+		tmp[i++] = '0' + v % 10;
+		v /= 10;
+	}
+	
+	if (i == 0)
+	{
+		*buf++ = '0';
+	}
+	else
+	{
+		for (; i > 0; i--)
+		{
+			*buf++ = tmp[i-1];
+		}
+	}
+	
+	*buf = 0;
+}
+
+//Strom anzeigen (val in nA oder uA), ab 1000 in der nachsten Einheit mit einer Nachkommastelle
+void lcd_show_current(unsigned int val, uint8_t prefix)
+{
+	char tmpBuf[6];
+	
+	if(val >= 1000) {
+		itoa(val / 1000, tmpBuf);
+		Out(tmpBuf);
+		SendData('.');
+		val = (val % 1000) / 100;
+		prefix++;
+	}
+	itoa(val, tmpBuf);
+	Out(tmpBuf);
+	SendData(CurrentPrefix[prefix]);
+	SendData('A');
+}
+
+uint8_t cp1, cp2;			//Zu testende Kondensator-Pins, wenn Messung fur einzelne Pins gewahlt
+
+TestContext ctx[SOCKETS];	//Messergebnisse je Testsockel
+
+
+#if TEST_THYRISTOR
+//2. Seite fur Thyristor/Triac: Zundspannung und Haltestrom
+void lcd_show_gate(const TestContext *tc)
+{
+	char tmpBuf[6];
+	
+	SetCursor(1, LCD_PAGE);
+	Say(S_vg);
+	itoa(tc->ugt, tmpBuf);
+	Out(tmpBuf);
+	SendData('m');
+	if(tc->ihold) {
+		SetCursor(2, LCD_PAGE);
+		Say(S_IhMax);
+		lcd_show_current(tc->ihold, CUR_UA);
+	}
+}
+#endif
+
+//2. Zeile der 2. Seite: differentieller Widerstand und Idealitatsfaktor
+void lcd_show_diode(const struct Diode *d)
+{
+	char tmpBuf[6];
+
+	SetCursor(2, LCD_PAGE);
+	Say(S_rd);
+	itoa(d->Rd, tmpBuf);
+	Out(tmpBuf);
+	Say(S_Ideality);	//"R n="
+	itoa(d->Ideality / 10, tmpBuf);
+	Out(tmpBuf);
+	SendData('.');
+	SendData(d->Ideality % 10 + '0');
+}
+
+#if TEST_RECOVERY
+//Speicherzeit: <500ns, 750ns, 4.2us, 12us; mit limit ">" davor
+void lcd_show_trr(unsigned int ns, uint8_t limit)
+{
+	char tmpBuf[6];
+
+	if(limit) SendData('>');
+	if(ns < RR_ULTRA_NS) {	//unter der Auflosung der Messung
+		SendData('<');
+		ns = RR_ULTRA_NS;
+	}
+	if(ns < 1000) {
+		itoa(ns, tmpBuf);
+		Out(tmpBuf);
+		SendData('n');
+	} else {
+		itoa(ns / 1000, tmpBuf);
+		Out(tmpBuf);
+		if(ns < 10000) {	//eine Nachkommastelle
+			SendData('.');
+			SendData((ns % 1000) / 100 + '0');
+		}
+		SendData(GLYPH_MICRO);
+	}
+	SendData('s');
+}
+#endif
+
+#if TEST_NETWORK
+//Widerstand mit hochstens 4 Zeichen: 680R, 4.7k, 47k, 470k, 1.2M, 12M
+void lcd_show_ohm(unsigned long r)
+{
+	char tmpBuf[6];
+	char unit = 'R';
+
+	if(r >= 1000000) {
+		r /= 1000;
+		unit = 'M';
+	} else if(r >= 1000) {
+		unit = 'k';
+	}
+	if(unit != 'R') {
+		if(r < 10000) {		//eine Nachkommastelle
+			itoa(r / 1000, tmpBuf);
+			Out(tmpBuf);
+			SendData('.');
+			r = (r % 1000) / 100;
+		} else {
+			r /= 1000;
+		}
+	}
+	itoa(r, tmpBuf);
+	Out(tmpBuf);
+	SendData(unit);
+}
+
+//Zweipol-Netzwerk: Art, Pins und die Werte der Bauteile, Ruckgabe 1 = mit 2. Seite
+uint8_t ShowNetwork(const TestContext *tc)
+{
+	char tmpBuf[11];
+	const struct Diode *d = &tc->diodes[0];
+
+	if(tc->NetKind == NET_RC) {
+		Say(S_NetRC);	//"R||C: "
+		SendData(tc->ra + 49);
+		SendData('-');
+		SendData(tc->rb + 49);
+		SetLine(1);
+		Say(S_RValue);	//"R="
+		lcd_show_ohm(tc->netr);
+		Say(S_GateCap);	//" C="
+		if(tc->netc >= 10000) {
+			itoa(tc->netc / 1000, tmpBuf);
+			Out(tmpBuf);
+			SendData('n');
+		} else {
+			itoa(tc->netc, tmpBuf);
+			Out(tmpBuf);
+			SendData('p');
+		}
+		SendData('F');
+		return 0;
+	}
+	if(tc->NetKind == NET_RD) {
+		Say(S_NetRD);	//"D||R: "
+	} else {
+		Say((d->Kind == DIODE_PLAIN) ? S_NetDiode : S_NetLed);
+		Say(S_NetDS);	//"+R: "
+	}
+	Say(S_Anode);
+	SendData(d->Anode + 49);
+	Say(S_NextK);
+	SendData(d->Cathode + 49);
+	SetLine(1);
+	Say(S_Uf);
+	itoa(d->Voltage, tmpBuf);
+	Out(tmpBuf);
+	Say(S_mV);
+	Say(S_Rstr);	//" R="
+	lcd_show_ohm((tc->NetKind == NET_RD) ? tc->netr : d->Rs);
+	if((d->Kind > DIODE_PLAIN) && (d->Kind < DIODE_ZENER)) {
+		SetCursor(1, LCD_PAGE - 1);	//2. Seite: LED-Farbe, ihr Leerzeichen fallt in die unsichtbare Spalte davor
+		Say(S_LedColor + d->Kind);
+		return 1;
+	}
+	return 0;
+}
+#endif
+
+/*
+Shows the result of a test run: page 1 with part and pins,
+page 2 (DDRAM column LCD_PAGE) with the additional parameters.
+Only reads tc, the results are converted by TestPart, so the display can be repeated.
+Returns 1 if there is a page 2.
+*/
+uint8_t ShowResult(const TestContext *tc)
+{
+	char tmpBuf[17];
+#if TEST_RESISTOR
+	uint8_t len;
+#endif
+	uint8_t i, a, k;
+
+	ClearLcd(0);
+	if(tc->Timeout) {	//abgebrochener Test, keine Teilergebnisse anzeigen
+		Say(S_TestTimedOut);	//"Timeout!"
+		SetLine(1);
+		Say(S_TimeoutKind + tc->Timeout);
+		if(tc->Timeout != TIMEOUT_WDT) {	//nach einem IWDG-Reset ist der Schritt unbekannt
+			Say(S_StepStr);
+			SendData(tc->TimeoutStep + 48);
+		}
+		return 0;
+	}
+	if((tc->Charged == CHARGE_HELD) || (tc->Charged && (tc->PartFound == PART_NONE))) {	//Kondensator war geladen
+		Say(S_ChargedStr);	//"Charged part"
+		if(tc->Charged == CHARGE_HELD) SendData('!');
+		SetLine(1);
+		Say(S_StartStr);	//"U0="
+		itoa(tc->ucharge, tmpBuf);
+		Out(tmpBuf);
+		Say(S_mV);
+		return 0;
+	}
+	if(tc->Contact) {	//Vorprufung: Sockel leer, Kurzschluss oder ein Pin ohne Kontakt
+		Say((tc->Contact == CONTACT_SHORT) ? S_ShortStr : S_ContactStr);
+		SetLine(1);
+		Say(S_PinStr);	//"pin"
+		for(i = 0; i < 3; i++) {
+			if(tc->ContactPins & (1 << i)) {
+				SendData(' ');
+				SendData(i + 49);
+			}
+		}
+		return 0;
+	}
+	if(tc->PartFound == PART_DIODE) {
+		if(tc->NumOfDiodes == 1) {
+			//Standard-Diode oder LED
+			if((tc->diodes[0].Kind == DIODE_PLAIN) || (tc->diodes[0].Kind == DIODE_ZENER)) {
+#if TEST_RECOVERY
+				Say((tc->Recovery == RR_SCHOTTKY) ? S_Schottky : S_Diode);	//"Schottky " oder "Diode: "
+#else
+				Say(S_Diode);	//"Diode: "
+#endif
+			} else {
+				Say(S_Led);	//"LED: "
+			}
+			Say(S_Anode);
+			SendData(tc->diodes[0].Anode + 49);
+			Say(S_NextK);//";K="
+			SendData(tc->diodes[0].Cathode + 49);
+			SetLine(1);	//2. Zeile
+			Say(S_Uf);	//"Uf = "
+			itoa(tc->diodes[0].Voltage, tmpBuf);
+			Out(tmpBuf);
+			//lcd_string(itoa(diodes[0].Voltage, outval, 10));
+			Say(S_mV);
+			if(tc->diodes[0].Kind < DIODE_ZENER) Say(S_LedColor + tc->diodes[0].Kind);
+#if TEST_RECOVERY
+			Say(S_RecoveryKind + tc->Recovery);	//" std", " fast", " ufast"
+#endif
+			SetCursor(1, LCD_PAGE);	//2. Seite
+			Say(S_Ir);
+			lcd_show_current(tc->diodes[0].Leakage, CUR_NA);
+#if TEST_RECOVERY
+			if(tc->Recovery) {
+				SendData(' ');
+				lcd_show_trr(tc->trr, tc->trrlimit);
+			}
+#endif
+			lcd_show_diode(&tc->diodes[0]);
+			return 1;
+		} else if(tc->NumOfDiodes == 2) {
+		//Doppeldiode
+			if(tc->diodes[0].Anode == tc->diodes[1].Anode) {
+				//Common Anode
+				Say(S_DualDiode);	//Doppeldiode
+				Say(S_CA);	//"CA"	
+				SetLine(1); //2. Zeile
+				Say(S_Anode);
+				SendData(tc->diodes[0].Anode + 49);
+				Say(S_K1);	//";K1="
+				SendData(tc->diodes[0].Cathode + 49);
+				Say(S_K2);	//";K2="
+				SendData(tc->diodes[1].Cathode + 49);
+				SetCursor(1, LCD_PAGE);	//2. Seite
+				Say(S_Ir1);
+				lcd_show_current(tc->diodes[0].Leakage, CUR_NA);
+				SetCursor(2, LCD_PAGE);
+				Say(S_Ir2);
+				lcd_show_current(tc->diodes[1].Leakage, CUR_NA);
+				return 1;
+			} else if(tc->diodes[0].Cathode == tc->diodes[1].Cathode) {
+				//Common Cathode
+				Say(S_DualDiode);	//Doppeldiode
+				Say(S_CC);	//"CC"
+				SetLine(1); //2. Zeile
+				Say(S_K);	//"K="
+				SendData(tc->diodes[0].Cathode + 49);
+				Say(S_A1);		//";A1="
+				SendData(tc->diodes[0].Anode + 49);
+				Say(S_A2);		//";A2="
+				SendData(tc->diodes[1].Anode + 49);
+				SetCursor(1, LCD_PAGE);	//2. Seite
+				Say(S_Ir1);
+				lcd_show_current(tc->diodes[0].Leakage, CUR_NA);
+				SetCursor(2, LCD_PAGE);
+				Say(S_Ir2);
+				lcd_show_current(tc->diodes[1].Leakage, CUR_NA);
+				return 1;
+			} else if ((tc->diodes[0].Cathode == tc->diodes[1].Anode) && (tc->diodes[1].Cathode == tc->diodes[0].Anode)) {
+				//Antiparallel
+				for(i = 0; i < 2; i++) {
+					if((tc->diodes[i].Kind == DIODE_ZENER) && (tc->diodes[1-i].Voltage < 1000)) {
+						//Z-Diode: Durchbruch in der einen, normale Diode in der anderen Richtung
+						Say(S_Zener);	//"Zener: "
+						Say(S_Anode);
+						SendData(tc->diodes[i].Cathode + 49);
+						Say(S_NextK);
+						SendData(tc->diodes[i].Anode + 49);
+						SetLine(1); //2. Zeile
+						Say(S_Uz);	//"Uz="
+						itoa(tc->diodes[i].Voltage, tmpBuf);
+						Out(tmpBuf);
+						Say(S_mV);
+						SetCursor(1, LCD_PAGE);	//2. Seite
+						Say(S_Uf);
+						itoa(tc->diodes[1-i].Voltage, tmpBuf);
+						Out(tmpBuf);
+						Say(S_mV);
+						lcd_show_diode(&tc->diodes[i]);
+						return 1;
+					}
+				}
+				Say(S_TwoDiodes);	//2 Dioden
+				SetLine(1); //2. Zeile
+				Say(S_Antiparallel);	//Antiparallel
+				return 0;
+			}
+		} else if(tc->NumOfDiodes == 3) {
+			//Serienschaltung aus 2 Dioden; wird als 3 Dioden erkannt
+			a = 3;
+			k = 3;
+			/* Uberprufen auf eine fur eine Serienschaltung von 2 Dioden mogliche Konstellation
+				Dafur mussen 2 der Kathoden und 2 der Anoden ubereinstimmen.
+				Das kommmt daher, dass die Dioden als 2 Einzeldioden und ZUSATZLICH als eine "gro?e" Diode erkannt werden.
+			*/
+			if((tc->diodes[0].Anode == tc->diodes[1].Anode) || (tc->diodes[0].Anode == tc->diodes[2].Anode)) a = tc->diodes[0].Anode;
+			if(tc->diodes[1].Anode == tc->diodes[2].Anode) a = tc->diodes[1].Anode;
+
+			if((tc->diodes[0].Cathode == tc->diodes[1].Cathode) || (tc->diodes[0].Cathode == tc->diodes[2].Cathode)) k = tc->diodes[0].Cathode;
+			if(tc->diodes[1].Cathode == tc->diodes[2].Cathode) k = tc->diodes[1].Cathode;
+			if((a<3) && (k<3)) {
+				Say(S_TwoDiodes);//2 Dioden
+				SetLine(1); //2. Zeile
+				Say(S_InSeries); //"in Serie A="
+				SendData(a + 49);
+				Say(S_NextK);
+				SendData(k + 49);
+				return 0;
+			}
+		}
+#if TEST_BJT
+	} else if (tc->PartFound == PART_TRANSISTOR) {
+		if(tc->PartMode == PART_MODE_NPN) {
+			Say(S_NPN);
+		} else {
+			Say(S_PNP);
+		}
+		Say(S_bstr);	//B=
+		SendData(tc->b + 49);
+		Say(S_cstr);	//;C=
+		SendData(tc->c + 49);
+		Say(S_estr);	//;E=
+		SendData(tc->e + 49);
+		SetCursor(1, LCD_PAGE);	//2. Seite: hFE mit R_L an der Basis und UCE(sat)
+		Say(S_hfestr);
+		if(tc->hfe2) {
+			itoa(tc->hfe2, tmpBuf);
+			Out(tmpBuf);
+		} else {
+			SendData('-');	//Emitterfolger gesattigt
+		}
+		Say(S_Vsat);	//" Vs="
+		itoa(tc->vcesat[1], tmpBuf);
+		Out(tmpBuf);
+		SendData('m');
+		SetCursor(2, LCD_PAGE);	//Leckstrome ICEO/ICBO
+		Say(S_Ir);
+		lcd_show_current(tc->ileak[0], CUR_NA);
+		SendData('/');
+		lcd_show_current(tc->ileak[1], CUR_NA);
+		SetLine(1); //2. Zeile
+		Say(S_hfestr);	//"hFE="
+		itoa(tc->hfe[1], tmpBuf);
+		Out(tmpBuf);
+		//lcd_string(utoa(hfe[1], outval, 10));
+		SetCursor(2,7);			//Cursor auf Zeile 2, Zeichen 7
+		if(tc->NumOfDiodes > 2) {	//Transistor mit Schutzdiode
+			SendData(GLYPH_DIODE);	//Diode anzeigen
+		} else {
+//			#ifdef UseM8
+				SendData(' ');
+//			#endif
+		}
+//		#ifdef UseM8
+			for(i=0;i<tc->NumOfDiodes;i++) {
+				if(((tc->diodes[i].Cathode == tc->e) && (tc->diodes[i].Anode == tc->b) && (tc->PartMode == PART_MODE_NPN)) || ((tc->diodes[i].Anode == tc->e) && (tc->diodes[i].Cathode == tc->b) && (tc->PartMode == PART_MODE_PNP))) {
+					Say(S_Uf);	//"Uf="
+					itoa(tc->diodes[i].Voltage, tmpBuf);
+					Out(tmpBuf);
+					SendData('m');
+					return 1;
+				}
+			}
+//		#endif
+		return 1;
+#endif
+#if TEST_FET
+	} else if (tc->PartFound == PART_FET) {	//JFET oder MOSFET
+		if(tc->PartMode&1) {	//N-Kanal
+			SendData('N');
+		} else {
+			SendData('P');	//P-Kanal
+		}
+		if((tc->PartMode==PART_MODE_N_D_MOS) || (tc->PartMode==PART_MODE_P_D_MOS)) {
+			Say(S_dmode);	//"-D"
+			Say(S_mosfet);	//"-MOS"
+		} else {
+			if((tc->PartMode==PART_MODE_N_JFET) || (tc->PartMode==PART_MODE_P_JFET)) {
+				Say(S_jfet);	//"-JFET"
+			} else {
+				Say(S_emode);	//"-E"
+				Say(S_mosfet);	//"-MOS"
+			}
+		}
+/*TODO		#ifdef UseM8	//Gatekapazitat
+			if(PartMode < 3) {	//Anreicherungs-MOSFET
+				lcd_eep_string(GateCap);	//" C="
+				ReadCapacity(b,e);	//Messung
+				hfe[0] = (unsigned int)cv;
+				if(hfe[0]>2) hfe[0] -= 3;
+				utoa(hfe[0], outval2, 10);
+
+				tmpval = strlen(outval2);
+				tmpval2 = tmpval;
+				if(tmpval>4) tmpval = 4;	//bei Kapazitat >100nF letze Nachkommastelle nicht mehr angeben (passt sonst nicht auf das LCD)
+				lcd_show_format_cap(outval2, tmpval, tmpval2);
+				lcd_data('n');
+			}
+		#endif*/
+		if(tc->PartMode < 3) {	//Anreicherungs-MOSFET: Drainstrom bei entladenem Gate
+			SetCursor(1, LCD_PAGE);	//2. Seite
+			Say(S_Idss);
+			lcd_show_current(tc->ileak[0], CUR_NA);
+		}
+		SetLine(1); //2. Zeile
+		Say(S_gds);	//"GDS="
+		SendData(tc->b + 49);
+		SendData(tc->c + 49);
+		SendData(tc->e + 49);
+		if((tc->NumOfDiodes > 0) && (tc->PartMode < 3)) {	//MOSFET mit Schutzdiode; gibt es nur bei Anreicherungs-FETs
+			SendData(GLYPH_DIODE);	//Diode anzeigen
+		} else {
+			SendData(' ');	//Leerzeichen
+		}
+		if(tc->PartMode < 3) {	//Anreicherungs-MOSFET
+			if(tc->gthvoltage) {	//0: Drain hat nicht geschaltet (GateThreshold)
+				Say(S_vt);
+				itoa(tc->gthvoltage, tmpBuf);
+				Out(tmpBuf);	//Gate-Schwellspannung, wurde zuvor ermittelt
+				SendData('m');
+			}
+		} else {	//Verarmungs-FET
+			Say(S_vp);
+			itoa(tc->upinch, tmpBuf);
+			Out(tmpBuf);	//Abschnurspannung
+			SendData('m');
+			SetCursor(1, LCD_PAGE);	//2. Seite
+			if(tc->idsslimited) {
+				Say(S_IdssMin);	//Strom durch R_L begrenzt, wirklicher IDSS ist hoher
+			} else {
+				Say(S_Idss);
+			}
+			lcd_show_current(tc->idss, CUR_UA);
+		}
+		return 1;
+#endif
+#if TEST_THYRISTOR
+	} else if (tc->PartFound == PART_THYRISTOR) {
+		Say(S_Thyristor);	//"Thyristor"
+		lcd_show_gate(tc);
+		SetLine(1); //2. Zeile
+		Say(S_GAK);	//"GAK="
+		SendData(tc->b + 49);
+		SendData(tc->c + 49);
+		SendData(tc->e + 49);
+		SendData(' ');
+		if(tc->igtlimit) Say(S_IgMin); else Say(S_IgMax);
+		lcd_show_current(tc->igt, CUR_UA);
+		return 1;
+	} else if (tc->PartFound == PART_TRIAC) {
+		Say(S_Triac);	//"Triac"
+		lcd_show_gate(tc);
+		SetCursor(1, LCD_PAGE + 8);	//Zundstrom hinter Vg= auf der 2. Seite
+		if(tc->igtlimit) Say(S_IgMin); else Say(S_IgMax);
+		lcd_show_current(tc->igt, CUR_UA);
+		SetLine(1); //2. Zeile
+		Say(S_Gate);
+		SendData(tc->b + 49);
+		Say(S_A1);		//";A1="
+		SendData(tc->e + 49);
+		Say(S_A2);		//";A2="
+		SendData(tc->c + 49);
+		return 1;
+#endif
+#if TEST_RESISTOR
+		} else if(tc->PartFound == PART_RESISTOR) {
+			Say(S_Resistor); //"Widerstand: "
+			SendData(tc->ra + 49);	//Pin-Angaben
+			SendData('-');
+			SendData(tc->rb + 49);
+			SetLine(1); //2. Zeile
+			itoa(tc->rvalue, tmpBuf);
+
+			if(tc->rk) {	//470k-Widerstand?
+				char *tmpS = tmpBuf;
+				len = 0;
+				while(*tmpS++)
+					len++;
+					
+				//len = strlen(outval);	//Notig, um Komma anzuzeigen
+				for(i=0;i<len;i++) {
+					SendData(tmpBuf[i]);
+					if(i==(len-2)) SendData('.');	//Komma
+				}
+				SendData ('k'); //Kilo-Ohm, falls 470k-Widerstand verwendet
+			} else {
+				Out(tmpBuf);
+			}
+			SendData(GLYPH_OHM);
+			return 0;
+#endif
+#if TEST_NETWORK
+		} else if(tc->PartFound == PART_NETWORK) {
+			return ShowNetwork(tc);
+#endif
+/*TODO
+		} else if(PartFound == PART_CAPACITOR) {	//Kapazitatsmessung auch nur auf Mega8 verfugbar
+			lcd_eep_string(Capacitor);
+			lcd_data(ca + 49);	//Pin-Angaben
+			lcd_data('-');
+			lcd_data(cb + 49);
+			Line2(); //2. Zeile
+			tmpval2 = 'n';
+			if(cv > 99999) {	//ab 1µF
+				cv /= 1000;
+				tmpval2 = LCD_CHAR_U;
+			}
+			ultoa(cv, outval, 10);
+			tmpval = strlen(outval);
+			lcd_show_format_cap(outval, tmpval, tmpval);
+			lcd_data(tmpval2);
+			lcd_data('F');
+			return;
+	#endif*/
+	}
+//	#ifdef UseM8	//Unterscheidung, ob Dioden gefunden wurden oder nicht nur auf Mega8
+		if(tc->NumOfDiodes == 0) {
+			//Keine Dioden gefunden
+			Say(S_TestFailed1); //"Kein,unbek. oder"
+			SetLine(1); //2. Zeile
+			Say(S_TestFailed2); //"defektes "
+			Say(S_Bauteil);
+		} else {
+			Say(S_Bauteil);
+			Say(S_Unknown); //" unbek."
+			SetLine(1); //2. Zeile
+			Say(S_OrBroken); //"oder defekt"
+			SendData(tc->NumOfDiodes + 48);
+			SendData(GLYPH_DIODE);
+		}
+//	#endif
+	return 0;
+}
+
+//loscht alle Messergebnisse
+void ClearContext(TestContext *tc)
+{
+	uint8_t *p = (uint8_t *)tc;
+	uint16_t n = sizeof(TestContext);	//uber 255 Bytes
+
+	while(n--)
+		*p++ = 0;
+}
+
+#if MATCH
+MatchResult match;	//Ergebnis des Matchings fur das Bauteil in Fassung 1
+uint8_t NewBatchStarted;
+
+//Abstand in Promille als "3.1%", ab 100% ">"
+void lcd_show_permille(uint16_t d)
+{
+	char tmpBuf[7];
+
+	if(d >= 1000) {
+		SendData('>');
+		return;
+	}
+	itoa(d / 10, tmpBuf);
+	Out(tmpBuf);
+	SendData('.');
+	SendData(d % 10 + 48);
+	SendData('%');
+}
+
+//Bauteilnummern durch Kommas getrennt
+void lcd_show_parts(uint8_t *num, uint8_t n)
+{
+	char tmpBuf[4];
+	uint8_t i;
+
+	for(i = 0; i < n; i++) {
+		if(i) SendData(',');
+		itoa(num[i], tmpBuf);
+		Out(tmpBuf);
+	}
+}
+
+/*
+Tragt das Bauteil in die Serie ein: Transistoren mit hFE und UBE, einzelne Dioden mit Uf.
+Andere Bauteile werden nicht gespeichert, zwei Tests mit leerem Sockel (CONTACT_OPEN) hintereinander beginnen eine neue Serie.
+*/
+void MatchPart(TestContext *tc)
+{
+#if TEST_BJT
+	uint8_t i;
+#endif
+
+	match.Num = 0;
+	if(tc->Timeout) {
+		MatchEmpty(0);
+		return;
+	}
+	if(tc->PartFound == PART_NONE) {
+		NewBatchStarted = MatchEmpty(tc->Contact == CONTACT_OPEN);	//Kurzschluss, Kontaktfehler oder unbekanntes Teil zahlen nicht als leer
+		return;
+	}
+#if TEST_BJT
+	if(tc->PartFound == PART_TRANSISTOR) {
+		for(i = 0; i < tc->NumOfDiodes; i++) {	//B-E-Diode wie in ShowResult
+			if(((tc->diodes[i].Cathode == tc->e) && (tc->diodes[i].Anode == tc->b) && (tc->PartMode == PART_MODE_NPN)) || ((tc->diodes[i].Anode == tc->e) && (tc->diodes[i].Cathode == tc->b) && (tc->PartMode == PART_MODE_PNP))) {
+				MatchAdd(tc->PartMode, tc->hfe[1], tc->diodes[i].Voltage, &match);	//MATCH_NPN/PNP = PART_MODE_NPN/PNP
+				return;
+			}
+		}
+	}
+#endif
+	if((tc->PartFound == PART_DIODE) && (tc->NumOfDiodes == 1)) {
+		MatchAdd(MATCH_DIODE + tc->diodes[0].Kind, tc->diodes[0].Voltage, tc->diodes[0].Voltage, &match);
+		return;
+	}
+	MatchEmpty(0);	//nicht gespeichert, beendet aber eine Folge leerer Tests
+}
+
+/*
+Zeile 1: Nummer des Bauteils und nachster Partner, Zeile 2: bestes Paar,
+2. Seite: bestes Quartett und seine grosste Abweichung.
+Ruckgabe: 0 = nichts anzuzeigen, 1 = eine Seite, 2 = mit 2. Seite
+*/
+uint8_t ShowMatch(void)
+{
+	char tmpBuf[4];
+
+	if(!NewBatchStarted && (match.Num == 0)) return 0;
+	ClearLcd(0);
+	if(NewBatchStarted) {
+		Say(S_NewBatch);	//"New batch"
+		return 1;
+	}
+	SendData('#');
+	itoa(match.Num, tmpBuf);
+	Out(tmpBuf);
+	if(match.Partner) {
+		Say(S_MatchNear);
+		itoa(match.Partner, tmpBuf);
+		Out(tmpBuf);
+		SendData(' ');
+		lcd_show_permille(match.PartnerD);
+	}
+	if(match.PairD == 0xFFFF) return 1;
+	SetLine(1);
+	Say(S_PairStr);	//"Pair "
+	lcd_show_parts(match.Pair, 2);
+	SendData(' ');
+	lcd_show_permille(match.PairD);
+	if(match.QuadD == 0xFFFF) return 1;
+	SetCursor(1, LCD_PAGE);
+	Say(S_QuadStr);	//"Quad "
+	lcd_show_parts(match.Quad, 4);
+	SetCursor(2, LCD_PAGE);
+	lcd_show_permille(match.QuadD);
+	return 2;
+}
+#endif
+
+uint16_t FirstResultMs;	//Zeit vom Einschalten bis zur ersten Ergebnisanzeige, im Debugger ablesbar
+
+/*
+Einschwingzeit nach dem Setzen der Pins, mindestens ms.
+Die noch offene LCD-Initialisierung lauft dabei mit (nur GPIOD, kein ADC).
+*/
+void Settle(uint8_t ms)
+{
+	if(TicksToMs(Ticks()) >= LCD_POWERUP_MS) LcdElapsed(LCD_POWERUP_MS);	//der Zahler lauft seit dem Einschalten, auch die Messungen zahlen zur Wartezeit
+	while((ms >= LCD_STEP_MS) && LcdStep())
+		ms -= LCD_STEP_MS;
+	LcdElapsed(ms);
+	while(ms--)
+		delay(MS(1));
+}
+
+//wartet n * 100 ms und halt dabei den Watchdog an
+void Pause(uint8_t n)
+{
+	while(n--) {
+		WdtReset();
+		delay(MS(100));
+	}
+}
+
+int main(void) 
+{
+	uint8_t s, wdtboot, detail;
+
+	GPIO_DeInit(GPIOB);
+	GPIO_DeInit(GPIOC);
+
+	//InitClocks();
+	
+	wdtboot = WatchdogReset();
+	InitWatchdog();
+	StartLcd(GPIOD, GPIO_PIN_2, GPIO_PIN_3, GPIO_PIN_HNIB, TestRunning);	//Init und "Testing ..." laufen in den Wartezeiten des ersten Tests
+////////////////////////////////////
+	//TODO ADC Prescaler = 8
+	cp1 = (ctmode & 12) >> 2;
+	cp2 = ctmode & 3;
+	ctmode = (ctmode & 48) >> 4;
+	InitSockets();
+#if MATCH
+	InitMatch();
+#endif
+	TraceStart();
+	if(wdtboot) {	//der letzte Test hing, nicht wiederholen; neuer Test erst nach dem Aus-/Einschalten
+		for(s = 0; s < SOCKETS; s++) {
+			ClearContext(&ctx[s]);
+			ctx[s].Timeout = TIMEOUT_WDT;
+		}
+	} else {
+		ScanSockets();
+	}
+#if MATCH
+	MatchPart(&ctx[0]);	//EEPROM-Schreiben (etwa 3 ms je Byte) lauft, wahrend das LCD initialisiert wird
+#endif
+
+	FinishLcd();
+	LoadGlyphs();	//Dioden-, Ohm- und Mikro-Zeichen ins CGRAM
+	detail = ShowResult(&ctx[0]);
+	FirstResultMs = TicksToMs(Ticks());
+	TraceDump();	//LCD ist jetzt untatig, PD5 frei fur UART2
+	CurveSend();
+
+////////////////////////////////////
+	while(1)
+	{
+//		value = ReadAdc(7);
+//		itoa(value, v);
+//		Outline(0, "                ");
+//		Outline(0, v);
+//		delay(MS(50));
+		for(s = 0; s < SOCKETS; s++) {
+#if SOCKETS > 1
+			ClearLcd(0);
+			Say(S_SocketStr);	//"Socket "
+			SendData(s + 49);
+			Pause(10);
+			detail = ShowResult(&ctx[s]);
+#endif
+			Pause(20);
+			if(detail) {	//Ergebnis und Leckstrome abwechselnd je 2s anzeigen
+				ShowPage(1);
+				Pause(20);
+				ShowPage(0);
+			}
+		}
+#if MATCH
+		if((s = ShowMatch()) != 0) {	//Serie: Partner, bestes Paar und Quartett
+			Pause(20);
+			if(s > 1) {
+				ShowPage(1);
+				Pause(20);
+				ShowPage(0);
+			}
+			detail = ShowResult(&ctx[0]);
+		}
+#endif
+	}
+}
+
+/*
+Nach jedem Schritt von TestPart: Watchdog nachladen, ADC-Fehler und Zeitlimit prufen.
+Bei Uberschreitung wird die Art und der Schritt in tc vermerkt, der Test endet.
+*/
+uint8_t Overdue(TestContext *tc, uint8_t step)
+{
+	WdtReset();
+	if(ADCTimeout) {
+		tc->Timeout = TIMEOUT_ADC;
+	} else if(DeadlineExpired()) {
+		tc->Timeout = TIMEOUT_DEADLINE;
+	} else {
+		return 0;
+	}
+	tc->TimeoutStep = step;
+	return 1;
+}
+
+//Pin-Kombinationen von CheckPins in der Reihenfolge von TestPart: High, Low, Tristate
+const uint8_t Perm[6][3] = {{TP1, TP2, TP3}, {TP1, TP3, TP2}, {TP2, TP1, TP3}, {TP2, TP3, TP1}, {TP3, TP2, TP1}, {TP3, TP1, TP2}};
+
+//Kurzschlussprufung von PreCheck: q fest auf Masse, p uber R_L an Vcc
+void ShortPins(uint8_t p, uint8_t q)
+{
+	GPIOB->ODR = 0;
+	GPIOB->CR1 = (uint8_t)(1 << q);
+	GPIOB->DDR = (uint8_t)(1 << q);
+	GPIOC->ODR = (uint8_t)(1 << (p * 2 + 1));
+	GPIOC->CR1 = (uint8_t)(1 << (p * 2 + 1));
+	GPIOC->DDR = (uint8_t)(1 << (p * 2 + 1));
+}
+
+/*
+Vorprufung der Kontakte, wenige ms statt bis zu 1,5 s fur die Suche:
+jeder Pin wird uber R_H nach Vcc und nach Masse gezogen, die beiden anderen fest auf das
+andere Potential. Bleibt er beide Male am Potential seines R_H, hangt an ihm nichts unter
+etwa 20 MOhm. Gelesen wird schon nach CONTACT_OPEN_US: die Kapazitat von Pin, Sockel und Mux
+ist dann geladen, ein Kondensator ab etwa 50 pF (Tau von R_H uber 25 us) aber noch nicht,
+er zahlt als verbunden. Danach je Paar verbundener Pins R_L nach Vcc gegen fest Masse:
+bleibt die Spannung zwischen den beiden Pins unter CONTACT_SHORT_LSB, ist es ein Kurzschluss.
+Der Pin fest auf Masse liegt dabei selbst bei etwa 0,1 V (7 mA uber den Port), daher die Differenz.
+Ruckgabe: die Pin-Kombinationen fur TestPart, 0 = Sockel leer oder Kurzschluss (tc->Contact).
+Ein einzelner freier Pin ist bei Zweipolen normal: es bleiben die beiden Kombinationen,
+in denen er der Tristate-Pin ist.
+*/
+uint8_t PreCheck(TestContext *tc)
+{
+	uint8_t p, q, i, open = 0, mask = 0;
+	uint16_t up, down;
+
+	for(p = 0; p < 3; p++) {
+		GPIOB->ODR = 0;	//andere Pins fest auf Masse
+		GPIOB->CR1 = (uint8_t)(7 & ~(1 << p));
+		GPIOB->DDR = (uint8_t)(7 & ~(1 << p));
+		GPIOC->ODR = (uint8_t)(2 << (p * 2 + 1));	//p uber R_H an Vcc
+		GPIOC->CR1 = (uint8_t)(2 << (p * 2 + 1));
+		GPIOC->DDR = (uint8_t)(2 << (p * 2 + 1));
+		delay(US(CONTACT_OPEN_US));
+		up = ReadADCCoarse(p);
+		GPIOB->ODR = (uint8_t)(7 & ~(1 << p));	//andere Pins fest auf Vcc
+		GPIOC->ODR = 0;	//p uber R_H an Masse
+		delay(US(CONTACT_OPEN_US));
+		down = ReadADCCoarse(p);
+		if((up > 1023 - CONTACT_OPEN_LSB) && (down < CONTACT_OPEN_LSB)) open |= (1 << p);
+	}
+	for(p = 0; (p < 3) && !tc->Contact; p++) {
+		q = (p == TP3) ? TP1 : p + 1;
+		if(open & ((1 << p) | (1 << q))) continue;	//ein freier Pin hat keinen Kurzschluss
+		ShortPins(p, q);
+		Settle(CONTACT_SETTLE_MS);
+		if(ReadADCDiff(p, q, 0) >= CONTACT_SHORT_LSB) continue;
+		DischargeAll(0, DISCHARGE_FAST_MS);	//oder ein MOSFET, dessen Gate ein voriges Paar geladen hat
+		ShortPins(p, q);
+		Settle(CONTACT_SHORT_MS);	//oder ein ungeladener Elko, der steigt inzwischen
+		if(ReadADCDiff(p, q, 0) < CONTACT_SHORT_LSB) {
+			tc->Contact = CONTACT_SHORT;
+			tc->ContactPins = (1 << p) | (1 << q);
+		}
+	}
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+	GPIOC->ODR = 0;
+	GPIOB->DDR = 0;
+	GPIOB->CR1 = 0;
+	GPIOB->ODR = 0;
+
+	if(open == 7) {
+		tc->Contact = CONTACT_OPEN;
+		tc->ContactPins = 7;
+	}
+	if(tc->Contact) return 0;
+	for(i = 0; i < 6; i++) {
+		if(!open || (open & (1 << Perm[i][2]))) mask |= (1 << i);
+	}
+	return mask;
+}
+
+#if FP_CACHE
+const uint8_t PermReverse[6] = {2, 5, 0, 4, 3, 1};	//dieselben Pins, High und Low vertauscht
+
+struct Print {
+	uint8_t fp[3];		//Leitzustand je Pin-Kombination und Tristate-Richtung, je 2 Bit
+	uint8_t mask;		//Pin-Kombinationen, die das Ergebnis brauchen
+	uint8_t part;		//PartFound << 4 | PartMode
+	uint8_t pins;		//b | c << 2 | e << 4
+	uint8_t diode;		//NumOfDiodes << 4 | Anode << 2 | Cathode von diodes[0]
+};
+struct Print prints[FP_CACHE];	//zuletzt getroffener Eintrag vorne, part = 0: leer
+
+/*
+Schneller Fingerabdruck, etwa 15 ms statt 400 ms fur alle CheckPins:
+je Pin-Kombination High fest auf Vcc, Low uber R_L auf Masse, Tristate uber R_L
+erst auf Masse, dann auf Vcc; eine grobe Messung am Low-Pin in 4 Stufen
+(sperrt, Leckstrom, leitet teilweise, leitet) wie die Schwellen von CheckPins.
+*/
+void Fingerprint(uint8_t *fp)
+{
+	uint8_t k, g, n = 0;
+	uint16_t u;
+
+	fp[0] = fp[1] = fp[2] = 0;
+	for(k = 0; k < 6; k++) {
+		for(g = 0; g < 2; g++) {
+			GPIOB->ODR = (1 << Perm[k][0]);	//High-Pin fest auf Vcc
+			GPIOB->CR1 = (1 << Perm[k][0]);
+			GPIOB->DDR = (1 << Perm[k][0]);
+			GPIOC->ODR = g ? (1 << (Perm[k][2] * 2 + 1)) : 0;	//Tristate uber R_L auf Masse bzw. Vcc
+			GPIOC->CR1 = (1 << (Perm[k][1] * 2 + 1)) | (1 << (Perm[k][2] * 2 + 1));
+			GPIOC->DDR = (1 << (Perm[k][1] * 2 + 1)) | (1 << (Perm[k][2] * 2 + 1));
+			delay(MS(1));
+			u = ReadADCCoarse(Perm[k][1]);
+			fp[n >> 2] |= ((u < 20) ? 0 : (u < 200) ? 1 : (u < 700) ? 2 : 3) << ((n & 3) * 2);
+			n++;
+		}
+	}
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+	GPIOC->ODR = 0;
+	GPIOB->DDR = 0;
+	GPIOB->CR1 = 0;
+	GPIOB->ODR = 0;
+}
+
+//CRC-16/CCITT uber die beiden Bytes von v
+uint16_t Crc16(uint16_t crc, uint16_t v)
+{
+	uint8_t i;
+
+	crc ^= v;
+	for(i = 0; i < 16; i++) {
+		crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+//andert sich, wenn CheckPins etwas gefunden hat; der Sperrstrom jeder Kombination zahlt nicht
+//CRC statt Summe: bei einer Summe heben sich gegenlaufige Anderungen auf
+uint16_t Digest(TestContext *tc)
+{
+	uint16_t crc = 0xFFFF;
+
+	crc = Crc16(crc, tc->NumOfDiodes | (tc->PartFound << 8) | (tc->tmpPartFound << 12));
+	crc = Crc16(crc, tc->PartMode | (tc->PartReady << 4) | (tc->b << 6) | (tc->c << 8) | (tc->e << 10) | (tc->ra << 12) | (tc->rb << 14));
+	crc = Crc16(crc, tc->hfe[0]);
+	crc = Crc16(crc, tc->hfe[1]);
+	crc = Crc16(crc, tc->uBE[0]);
+	crc = Crc16(crc, tc->uBE[1]);
+	crc = Crc16(crc, tc->rv[0]);
+	return Crc16(crc, tc->rv[1]);
+}
+
+//Klassifikation fur den Vergleich mit dem Cache
+void Classify(TestContext *tc, struct Print *p)
+{
+	p->part = (tc->PartFound << 4) | tc->PartMode;
+	p->pins = tc->b | (tc->c << 2) | (tc->e << 4);
+	p->diode = (tc->NumOfDiodes << 4) | (tc->diodes[0].Anode << 2) | tc->diodes[0].Cathode;
+}
+
+//Eintrag mit dem Fingerabdruck fp nach vorne holen; 0 wenn keiner
+struct Print *FindPrint(uint8_t *fp)
+{
+	struct Print tmp;
+	uint8_t i;
+
+	for(i = 0; i < FP_CACHE; i++) {
+		if(prints[i].part && (prints[i].fp[0] == fp[0]) && (prints[i].fp[1] == fp[1]) && (prints[i].fp[2] == fp[2])) {
+			tmp = prints[i];
+			for(; i > 0; i--) prints[i] = prints[i - 1];
+			prints[0] = tmp;
+			return &prints[0];
+		}
+	}
+	return 0;
+}
+
+//neuer Eintrag vorne, der alteste fallt heraus
+void StorePrint(TestContext *tc, uint8_t *fp, uint8_t mask)
+{
+	uint8_t i;
+
+	for(i = FP_CACHE - 1; i > 0; i--) prints[i] = prints[i - 1];
+	prints[0].fp[0] = fp[0];
+	prints[0].fp[1] = fp[1];
+	prints[0].fp[2] = fp[2];
+	prints[0].mask = mask;
+	Classify(tc, &prints[0]);
+}
+#endif
+
+/*
+Test aller Sockel. Messleitungen, ADC und R_L/R_H gehoren uber den Multiplexer immer nur
+einem Sockel, neben einem Test kann nur die Entladung der anderen uber ihre DIS-Leitung laufen.
+Daher zuerst ProbePart fur jeden Sockel (etwa 10 ms bei einem geladenen Kondensator, sonst
+wenige ms), dann MeasurePart: erst die ungeladenen Sockel, die geladenen zuletzt. Deren Entladung
+uber DIS (10 Ohm statt R_L) lauft wahrend der anderen Tests und ist dann meist fertig.
+*/
+void ScanSockets(void)
+{
+	uint8_t s, last;
+
+	for(s = 0; s < SOCKETS; s++) {
+		TraceMark(TRACE_SOCKET + s);
+		SelectSocket(s);
+		ProbePart(&ctx[s]);
+	}
+	for(last = 0; last < 2; last++) {
+		for(s = 0; s < SOCKETS; s++) {
+			if((ctx[s].Charged != CHARGE_NONE) != last) continue;
+			TraceMark(TRACE_SOCKET + s);
+			SelectSocket(s);
+			MeasurePart(&ctx[s]);
+			if(s == 0) CurveCapture(&ctx[0]);	//Kennlinie, solange der Sockel noch gewahlt ist
+		}
+	}
+	ReleaseSockets();
+}
+
+//Kompletter Test des Bauteils im gewahlten Sockel, ohne die Uberlappung von ScanSockets
+void TestPart(TestContext *tc)
+{
+	ProbePart(tc);
+	MeasurePart(tc);
+}
+
+/*
+Erster Blick auf den gewahlten Sockel: Ladung und Kontakte.
+Ist nach DISCHARGE_FAST_MS noch Spannung da, bleibt der Kondensator fur MeasurePart geladen
+(Charged): mit mehreren Sockeln entladt ihn DIS, bis er an der Reihe ist.
+*/
+void ProbePart(TestContext *tc)
+{
+	ClearContext(tc);
+	ADCTimeout = 0;
+	tc->Charged = DischargeAll(&tc->ucharge, DISCHARGE_FAST_MS);
+	tc->ucharge = AdcToMv(tc->ucharge);
+	if(tc->Charged != CHARGE_NONE) {
+		tc->Charged = CHARGE_FOUND;
+		return;
+	}
+	tc->Perms = PreCheck(tc);
+}
+
+/*
+Suche des Bauteils im gewahlten Sockel nach ProbePart, alle Ergebnisse in tc
+Dauer hochstens TEST_DEADLINE plus ein Schritt (watchdog.h)
+Mit FP_CACHE: ist der Fingerabdruck bekannt, laufen nur die Pin-Kombinationen,
+die fur diese Bauteilart etwas gefunden haben (und ihre Umkehrung fur die Sperrstrome).
+Ergibt das nicht dieselbe Klassifikation, folgt die volle Suche.
+*/
+void MeasurePart(TestContext *tc)
+{
+	uint8_t i, pre, mask;
+#if FP_CACHE
+	uint8_t fp[3], used = 0;
+	uint16_t d;
+	struct Print *hit, now;
+#endif
+
+	if(tc->Charged != CHARGE_NONE) {	//vor dem Zeitlimit, ein geladener Kondensator braucht uber R_L bis zu 2 s
+		if(DischargeAll(0, DISCHARGE_MAX_MS) == CHARGE_HELD) {
+			tc->Charged = CHARGE_HELD;	//ware fur den ADC und die Pins gefahrlich
+			return;
+		}
+		tc->Perms = PreCheck(tc);
+	}
+	pre = tc->Perms;
+	if(pre == 0) return;	//Sockel leer oder Kurzschluss, keine Suche
+	mask = pre;
+	StartDeadline(TEST_DEADLINE);
+#if FP_CACHE
+	Fingerprint(fp);
+	hit = FindPrint(fp);
+	if(hit) mask = hit->mask & pre;
+search:
+#endif
+	for(i = 0; i < 6; i++) {
+		if(!(mask & (1 << i))) continue;
+		TraceMark(i);
+#if FP_CACHE
+		d = Digest(tc);
+#endif
+		CheckPins(tc, Perm[i][0], Perm[i][1], Perm[i][2]);
+		if(Overdue(tc, i)) return;
+#if FP_CACHE
+		if(Digest(tc) != d) used |= (1 << i) | (1 << PermReverse[i]);
+#endif
+	}
+#if FP_CACHE
+	if(hit) {
+		Classify(tc, &now);
+		if((now.part != hit->part) || (now.pins != hit->pins) || (now.diode != hit->diode)) {
+			hit->part = 0;	//anderes Bauteil mit demselben Fingerabdruck: Eintrag verwerfen
+			hit = 0;
+			i = tc->Charged;
+			d = tc->ucharge;
+			ClearContext(tc);
+			tc->Charged = i;
+			tc->ucharge = d;
+			tc->Perms = pre;
+			mask = pre;
+			used = 0;
+			goto search;
+		}
+	} else if(tc->PartFound != PART_NONE) {
+		StorePrint(tc, fp, used);
+	}
+#endif
+	if((pre != 0x3F) && (tc->PartFound == PART_NONE) && (tc->NumOfDiodes == 0)) {	//ein Pin ohne Verbindung und nichts gefunden
+		tc->Contact = CONTACT_PIN;
+		for(i = 0; i < 6; i++) {
+			if(pre & (1 << i)) tc->ContactPins |= (1 << Perm[i][2]);
+		}
+	}
+
+#if TEST_FET
+	if((tc->PartFound == PART_FET) && (tc->PartMode < PART_MODE_N_D_MOS)) {	//Anreicherungs-MOSFET: Drainstrom bei entladenem Gate
+		if(tc->PartMode&1) {
+			tc->ileak[0] = tc->leakage[tc->c][tc->e];
+		} else {
+			tc->ileak[0] = tc->leakage[tc->e][tc->c];
+		}
+	}
+	if((tc->PartFound == PART_FET) && (tc->PartMode >= PART_MODE_N_D_MOS)) {	//JFET oder Verarmungs-MOSFET
+		TraceMark(STEP_FET);
+		ReadDepletionFET(tc, tc->b, tc->c, tc->e);
+		if(Overdue(tc, STEP_FET)) return;
+	}
+#endif
+#if TEST_THYRISTOR
+	if((tc->PartFound == PART_THYRISTOR) || (tc->PartFound == PART_TRIAC)) {
+		TraceMark(STEP_THYRISTOR);
+		ReadThyristor(tc, tc->b, tc->c, tc->e);	//Gate, Anode bzw. A2, Kathode bzw. A1
+		if(Overdue(tc, STEP_THYRISTOR)) return;
+	}
+#endif
+#if TEST_BJT
+	if(tc->PartFound == PART_TRANSISTOR) {
+		if(tc->PartReady == 0) {	//Wenn 2. Prufung nie gemacht, z.B. bei Transistor mit Schutzdiode
+			tc->hfe[1] = tc->hfe[0];
+			tc->uBE[1] = tc->uBE[0];
+			tc->vcesat[1] = tc->vcesat[0];
+			tc->follow[1][0] = tc->follow[0][0];
+			tc->follow[1][1] = tc->follow[0][1];
+		}
+		if((tc->hfe[0]>tc->hfe[1])) {	//Wenn der Verstarkungsfaktor beim ersten Test hoher war: C und E vertauschen!
+			uint8_t tmp;
+			tc->hfe[1] = tc->hfe[0];
+			tc->uBE[1] = tc->uBE[0];
+			tc->vcesat[1] = tc->vcesat[0];
+			tc->follow[1][0] = tc->follow[0][0];
+			tc->follow[1][1] = tc->follow[0][1];
+			tmp = tc->c;
+			tc->c = tc->e;
+			tc->e = tmp;
+		}
+		//Verstarkungsfaktor mit R_H an der Basis: hFE = (U_RL / R_L) / (U_RH / R_H)
+		if(tc->uBE[1]<11) tc->uBE[1] = 11;
+		tc->hfe[1] = (unsigned int)FixDiv((unsigned long)tc->hfe[1] * RH_RL_RATIO, tc->uBE[1]);
+		if(tc->PartMode == PART_MODE_NPN) {
+			tc->ileak[0] = tc->leakage[tc->c][tc->e];	//ICEO, Basis offen
+			tc->ileak[1] = tc->leakage[tc->c][tc->b];	//ICBO, Emitter offen
+		} else {
+			tc->ileak[0] = tc->leakage[tc->e][tc->c];
+			tc->ileak[1] = tc->leakage[tc->b][tc->c];
+		}
+		FollowerGain(tc);
+	}
+#endif
+
+#if TEST_RESISTOR
+	if(tc->PartFound == PART_RESISTOR) ResistorValue(tc);
+#endif
+
+	//Sperrstrome den Dioden zuordnen (Messung in der Gegenrichtung)
+	for(i = 0; i < tc->NumOfDiodes; i++) {
+		tc->diodes[i].Leakage = tc->leakage[tc->diodes[i].Cathode][tc->diodes[i].Anode];
+	}
+#if TEST_NETWORK
+	FitNetwork(tc);
+#endif
+#if TEST_RECOVERY
+	if((tc->PartFound == PART_DIODE) && (tc->NumOfDiodes == 1) && (tc->diodes[0].Kind == DIODE_PLAIN)) {
+		TraceMark(STEP_RECOVERY);
+		ReadRecovery(tc);
+		if(Overdue(tc, STEP_RECOVERY)) return;
+	}
+#endif
+
+/*	if(((PartFound == PART_NONE) || (PartFound == PART_RESISTOR) || (PartFound == PART_DIODE)) && (ctmode > 0)) {
+		//Kondensator entladen; sonst ist evtl. keine Messung moglich
+			R_PORT = 0;
+			R_DDR = (1<<(TP1 * 2)) | (1<<(TP2 * 2)) | (1<<(TP3 * 2));
+			_delay_ms(10);
+			R_DDR = 0;
+		//Kapazitat in allen 6 Pin-Kombinationen messen
+		if(ctmode == 1) {
+			ReadCapacity(cp1, cp2);
+			ReadCapacity(cp2, cp1);
+		} else {
+			ReadCapacity(TP3, TP1);
+			ReadCapacity(TP3, TP2);
+			ReadCapacity(TP2, TP3);
+			ReadCapacity(TP2, TP1);
+			ReadCapacity(TP1, TP3);
+			ReadCapacity(TP1, TP2);
+		}
+	}*/
+}
+
+void DischargePin(uint8_t PinToDischarge, uint8_t DischargeDirection) 
+{
+	/*
+Connecting a component short set to a particular potential, until the pin is there (at most about 1 ms)
+This function is provided for discharging of MOSFET gate to protect diodes u.ä. MOSFETs to recognize können
+Parameters:
+Pinto discharge: to be unloaded pin
+Discharge direction: 0 = to ground (N-channel FET), 1 = to positive (P-channel FET)
+*/
+	uint8_t tmpval, cr1;
+	tmpval = (PinToDischarge * 2 + 1);		//nötig wegen der Anordnung der Widerstände
+
+	cr1 = GPIOC->CR1;
+	GPIOC->DDR |= (1<<tmpval);			//Pin auf Ausgang und über R_L auf Masse
+
+	if(DischargeDirection)
+	{
+		GPIOC->CR1 |= (1 << tmpval);			//Gegentakt: als Open-Drain zieht der Pin nur nach Masse
+		GPIOC->ODR |= (1 << tmpval);			//R_L aus
+	}
+		
+	//Gate uber R_L: wenige us, die Spannung wird gepruft statt 10 ms zu warten
+	if(DischargeDirection)
+		WaitADC(PinToDischarge, 1023 - DISCHARGE_LEVEL, 1, DISCHARGE_EDGE);
+	else
+		WaitADC(PinToDischarge, DISCHARGE_LEVEL, 0, DISCHARGE_EDGE);
+	GPIOC->DDR &= ~(1<<tmpval);			//Pin wieder auf Eingang
+	GPIOC->CR1 = cr1;
+	if(DischargeDirection) 
+		GPIOC->ODR &= ~(1<<tmpval);			//R_L aus
+}
+
+/*
+Entladt alle drei Pins gleichzeitig uber R_L nach Masse und misst dabei mit ReadADCScan
+(ein Durchlauf je Tick, 1 ms), bis alle unter DISCHARGE_LEVEL sind. Der feste Takt halt den
+Flight Recorder klein und legt die Messung an den Anfang des Ticks, so nimmt die Wiedergabe
+(tests/replay.c) an derselben Stelle das Zeitlimit.
+Ohne geladenes Bauteil ist das nach dem ersten Durchlauf der Fall. Braucht es langer als
+DISCHARGE_FAST_MS, war ein Kondensator geladen: es wird bis MaxMs weiter
+entladen (R_L begrenzt den Strom auf 7 mA), der Watchdog wird dabei nachgeladen.
+Eine negative Spannung am Kondensator misst der ADC nicht.
+Ruckgabe CHARGE_..., start (darf 0 sein) erhalt die hochste Spannung der ersten Messung.
+*/
+uint8_t DischargeAll(uint16_t *start, uint16_t MaxMs)
+{
+	uint16_t adc[3];
+	uint16_t t0, t, ms, max;
+	uint8_t charged = CHARGE_NONE;
+
+	GPIOB->DDR = 0;	//Pins hochohmig, nur R_L nach Masse
+	GPIOB->CR1 = 0;
+	GPIOC->ODR = 0;
+	GPIOC->CR1 = (1 << (TP1 * 2 + 1)) | (1 << (TP2 * 2 + 1)) | (1 << (TP3 * 2 + 1));
+	GPIOC->DDR = (1 << (TP1 * 2 + 1)) | (1 << (TP2 * 2 + 1)) | (1 << (TP3 * 2 + 1));
+	t0 = Ticks();
+	if(start) *start = 0;
+
+	while(1) {
+		ReadADCScan(adc);
+		max = adc[TP1];
+		if(adc[TP2] > max) max = adc[TP2];
+		if(adc[TP3] > max) max = adc[TP3];
+		if(start && (*start == 0)) *start = max;
+		if(max < DISCHARGE_LEVEL) break;
+		ms = TicksToMs(Ticks() - t0);
+		if(ms >= DISCHARGE_FAST_MS) charged = CHARGE_FOUND;
+		if(ms >= MaxMs) {
+			charged = CHARGE_HELD;
+			break;
+		}
+		WdtReset();
+		t = Ticks();
+		while(Ticks() == t);
+	}
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+
+	return charged;
+}
+
+#if TEST_RECOVERY
+//erster Durchgang von v uber (Rising) bzw. unter level, in 1/16 Punkt interpoliert; SWEEP_POINTS * 16 ohne Durchgang
+uint16_t Crossing(uint16_t *v, uint16_t level, uint8_t Rising)
+{
+	uint8_t i;
+	int a, b;
+
+	for(i = 0; i < SWEEP_POINTS; i++) {
+		b = (int)v[i] - (int)level;
+		if(!Rising) b = -b;
+		if(b > 0) {
+			if(i == 0) return 0;	//schon vor dem ersten Punkt
+			a = (int)v[i - 1] - (int)level;
+			if(!Rising) a = -a;		//a <= 0
+			return (uint16_t)((i - 1) * 16 + ((long)-a * 16) / (b - a));
+		}
+	}
+	return SWEEP_POINTS * 16;
+}
+
+/*
+Sperrverzogerung einer einzelnen Diode, aquivalente Abtastung mit SweepADC:
+Anode uber R_L an Vcc, Kathode uber R_L an Masse (etwa 3 mA in Flussrichtung), dann
+polt ein einziger Schreibzugriff auf GPIOC beide R_L um. Solange die gespeicherte Ladung
+abfliesst, leitet die Diode ruckwarts (etwa 4 mA, IF = IR wie bei der trr-Messung nach
+JEDEC) und die Anode bleibt bei etwa 2,7 V; danach fallt sie auf 0.
+Der freie dritte Pin hangt nur an seinem R_L, der mit der Kathode umschaltet: er springt
+im Moment des Umschaltens von 0 auf Vcc und liefert den Nullpunkt. Triggerlatenz,
+Abtastfenster und Befehlslaufzeit sind fur beide Pins gleich und fallen heraus.
+Die Punkte liegen 0,5 us auseinander, jede Wandlung mittelt aber uber ihr Abtastfenster
+(3 ADC-Takte, 3 us) und der Trigger schwankt um etwa einen Takt: beide Flanken sind uber
+SWEEP_APERTURE Punkte verschliffen. Die Interpolation in Crossing trifft die Mitte einer
+solchen Rampe, ihre 1/16 Punkt sind keine Genauigkeit. Ein Modell dieser Abtastung
+(Sprung, Kastenfenster, Jitter, 4 Wiederholungen, 0,5 LSB Rauschen) ergibt fur 0..4 us
+Fehler zwischen -470 und +250 ns, also etwa einen Punktabstand. Die Klassengrenzen liegen
+daher bei 0,5 und 1 us (RR_ULTRA_NS, RR_FAST_NS), kurzere Zeiten werden als "<500ns"
+angezeigt. Die ersten Punkte liegen vor der Flanke (SWEEP_LEAD), danach bleiben etwa 8 us;
+eine langsamere Diode sperrt darin nicht (trrlimit).
+*/
+void ReadRecovery(TestContext *tc)
+{
+	uint16_t ref[SWEEP_POINTS], v[SWEEP_POINTS];
+	uint8_t a = tc->diodes[0].Anode;
+	uint8_t k = tc->diodes[0].Cathode;
+	uint8_t f = 3 - a - k;	//freier Pin
+	uint8_t fwd, rev;
+	uint16_t t0, t1;
+
+	fwd = (uint8_t)(1 << (a * 2 + 1));
+	rev = (uint8_t)((1 << (k * 2 + 1)) | (1 << (f * 2 + 1)));
+	GPIOB->DDR = 0;	//nur die R_L treiben
+	GPIOB->CR1 = 0;
+	GPIOC->ODR = fwd;
+	GPIOC->CR1 = fwd | rev;
+	GPIOC->DDR = fwd | rev;
+	SweepADC(f, fwd, rev, ref);
+	SweepADC(a, fwd, rev, v);
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+	GPIOC->ODR = 0;
+
+	t0 = Crossing(ref, SWEEP_REPEAT * 1023 / 2, 1);	//Flanke des freien Pins
+	if((t0 < SWEEP_APERTURE * 16 / 2) || (t0 == SWEEP_POINTS * 16)) return;	//v[0] nicht sicher vor der Flanke, RR_NONE
+	t1 = Crossing(v, v[0] / 2, 0);	//Anode fallt unter die Halfte ihrer Spannung in Flussrichtung
+	if(t1 == SWEEP_POINTS * 16) tc->trrlimit = 1;
+	tc->trr = (t1 > t0) ? (unsigned int)(((uint32_t)(t1 - t0) * (1000000000UL / F_CPU)) / 16) : 0;
+
+	if(tc->trrlimit || (tc->trr >= RR_FAST_NS)) {
+		tc->Recovery = RR_STANDARD;
+	} else if(tc->trr >= RR_ULTRA_NS) {
+		tc->Recovery = RR_FAST;
+	} else if(tc->diodes[0].Voltage < RR_SCHOTTKY_MV) {
+		tc->Recovery = RR_SCHOTTKY;
+	} else {
+		tc->Recovery = RR_ULTRAFAST;
+	}
+}
+#endif
+#if TEST_FET
+/*
+Gate-Schwellspannung eines Anreicherungs-MOSFET, in CheckPins, solange die Pins noch gesetzt sind:
+Source fest, Drain uber R_L und Gate uber R_H am jeweils anderen Pegel (P-Kanal: Source Plus).
+Das Gate wird entladen (DischargePin) und ladt sich uber R_H, bis der Drain GATE_DRAIN erreicht.
+Dann sind alle Widerstande ab, das Gate halt seine Ladung und wird gemessen.
+Mittel aus GATE_SAMPLES Messungen in mV, 0 wenn der Drain nach EDGE_TIMEOUT nicht geschaltet hat.
+*/
+unsigned int GateThreshold(uint8_t Gate, uint8_t Drain, uint8_t PChannel)
+{
+	uint8_t i, ddr, cr1;
+	uint16_t sum = 0;
+
+	ddr = GPIOC->DDR;
+	cr1 = GPIOC->CR1;
+	for(i = 0; i < GATE_SAMPLES; i++) {
+		DischargePin(Gate, PChannel);
+		if(PChannel) {
+			if(WaitADC(Drain, GATE_DRAIN, 1, EDGE_TIMEOUT) <= GATE_DRAIN) return 0;
+		} else {
+			if(WaitADC(Drain, GATE_DRAIN, 0, EDGE_TIMEOUT) >= GATE_DRAIN) return 0;
+		}
+		GPIOC->DDR = 0;		//Drain und Gate hochohmig
+		GPIOC->CR1 = 0;		//ohne Pull-up
+		sum += ReadADCCoarse(Gate);
+		GPIOC->CR1 = cr1;
+		GPIOC->DDR = ddr;
+	}
+	sum /= GATE_SAMPLES;
+	if(PChannel) sum = 1023 - sum;	//gegen die Source an Plus
+
+	return AdcToMv(sum);
+}
+
+/*
+Characterization of depletion FETs (JFET, D-MOSFET), called once after the part is found.
+Gate firmly on source potential, drain over R_L; the source is stepped through the
+combinations of its pin, one ADC scan each:
+Step 0: source firmly on the gate  => saturation drain current IDSS at UGS = 0
+Step 1: source over R_L            => ID1 of about 1 mA, self bias UGS1
+Step 2: source over R_H            => ID2 of a few uA, UGS2 close to the pinch-off voltage
+In saturation sqrt(ID) falls linearly with UGS down to zero at the pinch-off voltage,
+so the line through steps 1 and 2 gives Vp = (UGS2 * sqrt(ID1) - UGS1 * sqrt(ID2)) / (sqrt(ID1) - sqrt(ID2)).
+This removes the gap of UGS2 to Vp (about 3% at IDSS = 5 mA); what remains is the deviation
+of the part from the square law, typically below 10%. Step 0 does not enter, so a drain
+current limited by R_L does not spoil Vp.
+If UDS in step 0 is below the pinch-off voltage, the drain current was limited by R_L.
+P-channel parts are measured mirrored: all readings are taken from the source potential.
+*/
+void ReadDepletionFET(TestContext *tc, uint8_t Gate, uint8_t Drain, uint8_t Source)
+{
+	uint16_t adc[3];
+	int uds = 0, ugs[3], us[3];
+	long vp;
+	uint32_t s1, s2;
+	uint8_t rd, rs, step, i;
+	
+	rd = (uint8_t)(1 << (Drain * 2 + 1));	//R_L am Drain
+	for(step = 0; step < 3; step++) {
+		rs = step ? (uint8_t)(1 << (Source * 2 + step)) : 0;	//Source fest, uber R_L, uber R_H
+		GPIOB->DDR = step ? (1 << Gate) : (1 << Gate) | (1 << Source);
+		GPIOB->CR1 = GPIOB->DDR;
+		GPIOC->DDR = rd | rs;
+		GPIOC->CR1 = rd | rs;
+		if(tc->PartMode & 1) {	//N-Kanal: Gate und Source auf Masse, Drain uber R_L auf Vcc
+			GPIOB->ODR = 0;
+			GPIOC->ODR = rd;
+		} else {			//P-Kanal: Gate und Source auf Vcc, Drain uber R_L auf Masse
+			GPIOB->ODR = GPIOB->DDR;
+			GPIOC->ODR = rs;
+		}
+		delay(MS(5));
+		ReadADCScan(adc);
+		if(!(tc->PartMode & 1)) {	//gespiegelt: alles vom Source-Potential aus
+			for(i = 0; i < 3; i++)
+				adc[i] = 1023 - adc[i];
+		}
+		us[step] = adc[Source];
+		ugs[step] = (int)adc[Source] - (int)adc[Gate];
+		if(ugs[step] < 0) ugs[step] = 0;
+		if(!step) {
+			tc->idss = AdcToUaRL(1023 - adc[Drain]);
+			uds = adc[Drain] - adc[Source];
+		}
+	}
+	
+	//sqrt(ID) in Einheiten von R_H, um 8 Bit skaliert fur die Auflosung bei wenigen LSB
+	s1 = FixSqrt(((uint32_t)us[1] * RH_RL_RATIO) << 8);
+	s2 = FixSqrt((uint32_t)us[2] << 8);
+	vp = ugs[2];
+	if((s1 > s2) && (ugs[1] < ugs[2]))
+		vp = ((long)ugs[2] * s1 - (long)ugs[1] * s2) / (long)(s1 - s2);
+	if(vp > 2046) vp = 2046;	//Gerade fast waagrecht: kein Abschnuren im Bereich der Messung
+	tc->upinch = AdcToMv((uint16_t)vp);	//in mV
+	tc->idsslimited = (uds < ugs[2]);
+	
+	GPIOB->DDR = 0;
+	GPIOB->CR1 = 0;
+	GPIOB->ODR = 0;
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+	GPIOC->ODR = 0;
+}
+
+#endif
+
+#if TEST_THYRISTOR
+/*
+Gate trigger and holding current of thyristors and triacs (anode/A2 and gate positive),
+called once after the part is found.
+The gate drive is stepped from R_H (about 9 uA) to R_L (about 6 mA); the first step that
+latches gives the upper bound of IGT, the gate voltage at that moment is VGT.
+Then the anode current is lowered in steps (R_L with cathode on ground, R_L with cathode
+over R_L, R_H); the last step that still holds gives the upper bound of IH.
+Resistors are always switched on before the old path is released, so the current never breaks.
+*/
+void ReadThyristor(TestContext *tc, uint8_t Gate, uint8_t Anode, uint8_t Cathode)
+{
+	uint16_t adc[3];
+	uint8_t ra, rg, rk;
+	
+	ra = (Anode * 2 + 1);	//R_L an der Anode, R_H ist ra+1
+	rg = (Gate * 2 + 1);	//R_L am Gate, R_H ist rg+1
+	rk = (Cathode * 2 + 1);	//R_L an der Kathode
+	tc->ihold = 0;
+	
+	//Kathode fest auf Masse, Anode uber R_L auf Plus, Gate uber R_L auf Masse => gesperrt
+	GPIOB->ODR = 0;
+	GPIOB->DDR = (1 << Cathode);
+	GPIOB->CR1 = (1 << Cathode);
+	GPIOC->ODR = (1 << ra);
+	GPIOC->DDR = (1 << ra) | (1 << rg);
+	GPIOC->CR1 = (1 << ra) | (1 << rg);
+	WaitADC(Anode, 900, 1, EDGE_TIMEOUT);
+	
+	//Gate uber R_H auf Plus
+	tc->igtlimit = 0;
+	GPIOC->DDR = (1 << ra) | (2 << rg);
+	GPIOC->CR1 = (1 << ra) | (2 << rg);
+	GPIOC->ODR = (1 << ra) | (2 << rg);
+	if(WaitADC(Anode, 500, 0, EDGE_TIMEOUT) < 500) {	//gezundet => empfindliches Gate
+		ReadADCScan(adc);
+		tc->igt = AdcToUaRH(1023 - adc[Gate]);
+	} else {	//Gate uber R_L auf Plus
+		GPIOC->DDR = (1 << ra) | (1 << rg);
+		GPIOC->CR1 = (1 << ra) | (1 << rg);
+		GPIOC->ODR = (1 << ra) | (1 << rg);
+		if(WaitADC(Anode, 500, 0, EDGE_TIMEOUT) >= 500) tc->igtlimit = 1;	//zundet auch mit R_L nicht
+		ReadADCScan(adc);
+		tc->igt = AdcToUaRL(1023 - adc[Gate]);
+	}
+	if(adc[Gate] > adc[Cathode]) {
+		tc->ugt = AdcToMv(adc[Gate] - adc[Cathode]);
+	} else {
+		tc->ugt = 0;
+	}
+	if(tc->igtlimit) goto thyend;
+	
+	//Gate hochohmig, Anodenstrom uber R_L mit Kathode auf Masse
+	GPIOC->DDR = (1 << ra);
+	GPIOC->CR1 = (1 << ra);
+	GPIOC->ODR = (1 << ra);
+	if(WaitADC(Anode, 900, 1, LATCH_WINDOW) > 900) goto thyend;	//halt sich nicht selbst
+	adc[Anode] = ReadADC(Anode);
+	tc->ihold = AdcToUaRL(1023 - adc[Anode]);
+	
+	//Kathode uber R_L auf Masse => etwa halber Strom
+	GPIOC->DDR = (1 << ra) | (1 << rk);
+	GPIOC->CR1 = (1 << ra) | (1 << rk);
+	GPIOB->DDR = 0;
+	GPIOB->CR1 = 0;
+	if(WaitADC(Anode, 900, 1, LATCH_WINDOW) > 900) goto thyend;	//geloscht
+	ReadADCScan(adc);
+	tc->ihold = AdcToUaRL(adc[Cathode]);
+	
+	//Kathode wieder fest auf Masse, Anode nur noch uber R_H
+	GPIOB->DDR = (1 << Cathode);
+	GPIOB->CR1 = (1 << Cathode);
+	GPIOC->DDR = (1 << ra) | (2 << ra);
+	GPIOC->CR1 = (1 << ra) | (2 << ra);
+	GPIOC->ODR = (1 << ra) | (2 << ra);
+	GPIOC->DDR = (2 << ra);
+	GPIOC->CR1 = (2 << ra);
+	GPIOC->ODR = (2 << ra);
+	delay(MS(1));
+	adc[Anode] = ReadADCSync(Anode);	//R_H: uber eine Netzperiode messen
+	if(adc[Anode] < 900) {	//halt sogar mit einigen uA
+		tc->ihold = AdcToUaRH(1023 - adc[Anode]);
+	}
+	
+	thyend:
+	GPIOB->DDR = 0;
+	GPIOB->CR1 = 0;
+	GPIOB->ODR = 0;
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+	GPIOC->ODR = 0;
+}
+#endif
+
+/*
+Function to test the properties of the component at the specified pin assignment
+Parameters:
+HighPin: pin, which is initially set to positive potential
+LowPin: pin, which is initially set at a negative potential
+TristatePin: pin, which is initially left open
+
+During testing TristatePin is switched course, also have a positive or negative.
+*/
+/*
+HighPin is placed firmly on Vcc
+LowPin is placed over R_L to GND
+TristatePin is switched to highZ	
+*/
+
+#if TEST_BJT
+/*
+Zweiter hFE-Punkt mit R_L an der Basis, in CheckPins gleich nach dem hFE mit R_H, solange
+die Pins des Transistors noch gesetzt sind. Mit dem Kollektor uber R_L ware er gesattigt, daher
+als Emitterfolger: Kollektor fest auf Vcc (pnp: Masse), Emitter uber R_L auf Masse (pnp: Vcc).
+Alle Knoten hangen an R_L oder fest an einem Pegel, es ist kein Einschwingen abzuwarten.
+Am R_L der Basis fallen bei hFE 300 nur etwa 3 LSB ab, daher ReadADCPairFine (1/16 LSB).
+Ergebnis in tc->follow[PartReady] wie hfe[] und uBE[], ausgewertet von FollowerGain.
+*/
+void ReadFollower(TestContext *tc, uint8_t Base, uint8_t Collector, uint8_t Emitter)
+{
+	uint16_t ue, ub;
+	uint8_t rb, re;
+
+	rb = (Base * 2 + 1);		//R_L der Basis
+	re = (Emitter * 2 + 1);		//R_L des Emitters
+	GPIOB->CR1 = (1 << Collector);
+	GPIOB->DDR = (1 << Collector);
+	GPIOC->CR1 = (1 << rb) | (1 << re);
+	GPIOC->DDR = (1 << rb) | (1 << re);
+	if(tc->PartMode == PART_MODE_NPN) {
+		GPIOB->ODR = (1 << Collector);	//Kollektor fest auf Vcc
+		GPIOC->ODR = (1 << rb);			//Basis uber R_L auf Vcc, Emitter uber R_L auf Masse
+		ReadADCPairFine(Emitter, Base, &ue, &ub);
+		tc->follow[tc->PartReady][0] = ue;
+		tc->follow[tc->PartReady][1] = 1023 * 16 - ub;
+	} else {
+		GPIOB->ODR = 0;					//Kollektor fest auf Masse
+		GPIOC->ODR = (1 << re);			//Basis uber R_L auf Masse, Emitter uber R_L auf Vcc
+		ReadADCPairFine(Emitter, Base, &ue, &ub);
+		tc->follow[tc->PartReady][0] = 1023 * 16 - ue;
+		tc->follow[tc->PartReady][1] = ub;
+	}
+}
+
+/*
+hFE des Emitterfolgers: IE / IB - 1, beide Strome uber R_L gemessen.
+Die Spannung am Emitter-R_L lasst UCE ubrig (Kollektor fest am anderen Pegel);
+unter HFE2_UCE_MIN gesattigt, kein Wert (hfe2 = 0).
+*/
+void FollowerGain(TestContext *tc)
+{
+	uint16_t ie = tc->follow[1][0];
+	uint16_t ib = tc->follow[1][1];
+
+	if(ib == 0) ib = 1;
+	if((ie > ib) && (ie <= (1023 - HFE2_UCE_MIN) * 16)) {
+		tc->hfe2 = (ie - ib + ib / 2) / ib;	//gerundet
+		tc->ic2 = AdcToUaRL((ie - ib + 8) >> 4);
+	}
+}
+#endif
+
+#if TEST_RESISTOR
+/*
+Widerstand aus den Spannungen von CheckPins: es zahlt die Messung (R_L oder R_H),
+deren Spannung naher an 512 liegt (bessere Genauigkeit).
+R = R_x * U_R / (Umax - U_R), mit R_H in 100 Ohm (rk)
+*/
+void ResistorValue(TestContext *tc)
+{
+	unsigned int d0, d1, rv, rmax, rx;
+
+	d0 = (tc->rv[0] > 512) ? (tc->rv[0] - 512) : (512 - tc->rv[0]);	//Abstand der Spannungen an den Testwiderstanden von 512
+	d1 = (tc->rv[1] > 512) ? (tc->rv[1] - 512) : (512 - tc->rv[1]);
+	if(d0 > d1) {
+		rv = tc->rv[1];
+		rmax = tc->radcmax[1];
+		rx = rhval;	//470k-Testwiderstand
+		tc->rk = 1;
+	} else {
+		rv = tc->rv[0];
+		rmax = tc->radcmax[0];
+		rx = rlval;	//680R-Testwiderstand
+		tc->rk = 0;
+	}
+	if(rv == 0) rv = 1;
+	tc->rvalue = FixDiv((unsigned long)rx * rv, rmax - rv);	//Widerstand berechnen
+}
+#endif
+
+#if TEST_NETWORK
+/*
+Leitet die Richtung HighPin -> LowPin linear (ohmsch)? Aus dem Wert mit R_L wird
+der Widerstand bestimmt und daraus die Spannung mit R_H vorhergesagt; sie muss
+auf 20 % + 5 LSB stimmen. Offen (kein Strom mit R_H) oder Kurzschluss zahlt nicht.
+*/
+uint8_t NetLinear(TestContext *tc, uint8_t HighPin, uint8_t LowPin)
+{
+	unsigned long v0, v1, m0, m1, p;
+
+	v0 = tc->netv[HighPin][LowPin][0];
+	v1 = tc->netv[HighPin][LowPin][1];
+	m0 = 1023 - tc->neto[HighPin][LowPin][0];
+	m1 = 1023 - tc->neto[HighPin][LowPin][1];
+	if((v0 < 3) || (v0 + 3 > m0) || (v1 + 20 > m1)) return 0;
+	p = (m1 * RL_OHM * v0) / (RL_OHM * v0 + RH_100 * 100UL * (m0 - v0));	//U mit R_H aus R = R_L * v0 / (m0 - v0)
+	if(v1 > p) p = v1 - p; else p = p - v1;
+	return ((p * 5) <= (v1 + 25));
+}
+
+//Widerstand der Richtung HighPin -> LowPin in Ohm, aus dem Wert naher an der Mitte
+unsigned long NetR(TestContext *tc, uint8_t HighPin, uint8_t LowPin)
+{
+	unsigned long v0, v1, m0, m1;
+
+	v0 = tc->netv[HighPin][LowPin][0];
+	v1 = tc->netv[HighPin][LowPin][1];
+	m0 = 1023 - tc->neto[HighPin][LowPin][0];
+	m1 = 1023 - tc->neto[HighPin][LowPin][1];
+	if(((v0 > m0 / 2) ? (v0 - m0 / 2) : (m0 / 2 - v0)) < ((v1 > m1 / 2) ? (v1 - m1 / 2) : (m1 / 2 - v1))) {
+		return (RL_OHM * v0) / (m0 - v0);
+	}
+	return (RH_100 * 100UL * v1) / (m1 - v1);
+}
+
+/*
+Zweipol-Netzwerke, nach allen Pin-Permutationen:
+Diode || R: die Vorwartsrichtung ist nichtlinear, in Sperrrichtung leitet nur R, linear.
+  Die Sperrrichtung wurde sonst als zweite, antiparallele Diode oder als Defekt erkannt.
+Diode + R: FitSeries hat einen Serienwiderstand gefunden, Uf ist die Spannung an der Diode.
+R || C wird schon im Widerstandstest erkannt (ReadRC).
+*/
+void FitNetwork(TestContext *tc)
+{
+	uint8_t i, a, k;
+	struct Diode *d;
+
+	if((tc->PartFound == PART_RESISTOR) && (tc->NetKind == NET_RC)) {
+		tc->PartFound = PART_NETWORK;
+		return;
+	}
+	if(tc->PartFound != PART_DIODE) return;
+	for(i = 0; i < tc->NumOfDiodes; i++) {
+		a = tc->diodes[i].Anode;
+		k = tc->diodes[i].Cathode;
+		if(!NetLinear(tc, a, k) && NetLinear(tc, k, a)) {
+			tc->diodes[0] = tc->diodes[i];
+			tc->NumOfDiodes = 1;
+			tc->netr = NetR(tc, k, a);
+			tc->NetKind = NET_RD;
+			tc->PartFound = PART_NETWORK;
+			return;
+		}
+	}
+	d = &tc->diodes[0];
+	if((tc->NumOfDiodes == 1) && d->Rs) {
+		d->Voltage = d->Uj;
+		d->Ideality = 0;	//der Wert aus zwei Punkten enthalt Rs
+		DiodeKind(d);
+		tc->NetKind = NET_DS;
+		tc->PartFound = PART_NETWORK;
+	}
+}
+
+/*
+R || C: Ladezeit uber R_H nach dem Entladen beider Pins.
+adcv[1] (Spannung uber dem Bauteil mit R_H) und adcv[3] (Low-Pin) sind die Endwerte,
+die Zeit bis 63 % davon ist tau = (R_H || R) * C mit R_H || R = R_H * U / (U + U_RH).
+Bei tau > 1 ms war der Endwert nach 5 ms noch nicht erreicht (der "wackelnde"
+Widerstand): dann nach 5 tau neu messen und die Zeit mit dem neuen Endwert wiederholen.
+Auflosung RISE_US; C wird ab 4 Wandlungen angegeben, mit R = 470k ab etwa 2,5 nF.
+Unter etwa 25k (U < 50) ist die Ladezeit uber R_H zu kurz.
+*/
+void ReadRC(TestContext *tc, uint8_t HighPin, uint8_t LowPin, unsigned int *adcv)
+{
+	uint8_t pass;
+	uint8_t tmpval = (HighPin * 2 + 1);
+	uint16_t n, i, ul;
+	unsigned long tau;
+
+	if(adcv[1] < 50) return;
+	for(pass = 0; pass < 2; pass++) {
+		GPIOC->DDR = 0;
+		GPIOC->CR1 = 0;
+		GPIOC->ODR = 0;
+		GPIOB->DDR = (1 << LowPin) | (1 << HighPin);	//beide Pins fest auf Masse: C entladen
+		GPIOB->CR1 = (1 << LowPin) | (1 << HighPin);
+		delay(MS(5));
+		GPIOB->DDR = (1 << LowPin);
+		GPIOB->CR1 = (1 << LowPin);
+		GPIOC->DDR = (2 << tmpval);	//High-Pin uber R_H auf Plus
+		GPIOC->CR1 = (2 << tmpval);
+		GPIOC->ODR = (2 << tmpval);
+		n = RiseTimeADC(HighPin, adcv[3] + (adcv[1] * 161) / 256, EDGE_TIMEOUT);
+		if(n >= EDGE_TIMEOUT) return;	//langer als etwa 37 ms: kein R || C messbar
+		tau = (unsigned long)n * RISE_US;
+		if((tau <= 1000) || pass) break;
+		for(i = 0; i < (tau / 200); i++) delay(MS(1));	//insgesamt uber 5 tau
+		adcv[1] = ReadADCDiff(HighPin, LowPin, &ul);
+		adcv[3] = ul;
+	}
+	if((n < 4) || (adcv[1] + adcv[3] + 3 > 1023)) return;
+	tc->netr = (RH_100 * 100UL * adcv[1]) / (1023 - adcv[3] - adcv[1]);
+	tc->netc = ((tau * (1023 - adcv[3]) / adcv[1]) * 10000) / RH_100;	//pF
+	tc->NetKind = NET_RC;
+}
+#endif
+
+void CheckPins(TestContext *tc, uint8_t HighPin, uint8_t LowPin, uint8_t TristatePin) {
+	unsigned int adcv[6];
+	uint16_t uc, ub;
+#if TEST_RESISTOR
+	uint16_t ul;
+#endif
+#if TEST_BJT || TEST_FET || TEST_THYRISTOR
+	uint16_t scan[3];
+	unsigned int sat;
+#endif
+	uint8_t tmpval, tmpval2;
+	WdtReset();
+	DischargeAll(0, DISCHARGE_FAST_MS);	//Ladung aus der vorigen Pin-Kombination, meist nur ein Scan
+	//Pins setzen
+	tmpval = (LowPin * 2 + 1);
+	GPIOC->DDR = (1 << tmpval);//Low-pin to output and to ground via R_L
+	GPIOC->CR1 = (1 << tmpval);//!!! all others - HiZ
+	GPIOC->ODR = 0;
+	GPIOB->DDR = (1 << HighPin);
+	GPIOB->CR1 = (1 << HighPin);//!!! all others - HiZ
+	GPIOB->ODR = (1 << HighPin);////High-pin to output and Vcc
+	Settle(5);
+	//Some MOSFETs must be the gate (TristatePin) first discharge
+	//N-Kanal:
+	DischargePin(TristatePin,0);
+	//voltage at Low-pin determined
+	adcv[0] = ReadADC(LowPin);
+	if(adcv[0] < 200) goto next;	//Locks the device now?
+	//else: Unload for P-channel (gate to plus)
+	DischargePin(TristatePin,1);
+	//voltage at Low-pin determined
+	adcv[0] = ReadADC(LowPin);
+
+	next:
+
+#if TEST_FET
+	if(adcv[0] > 19) {//Bauteil leitet ohne Steuerstrom etwas
+		//Test on N-JFET, or even conducting N-MOSFET
+		GPIOC->DDR |= (2<<(TristatePin*2 + 1));//Tristate Pin (suspected Gate) via R_H to ground
+		GPIOC->CR1 |= (2<<(TristatePin*2 + 1));//!!!
+		delay(MS(20));
+		adcv[1] = ReadADC(LowPin);		//Measure voltage at the suspected source
+		GPIOC->ODR |= (2<<(TristatePin*2 + 1)); //Tristate Pin (suspected Gate) via R_H to Plus
+		delay(MS(20));
+		adcv[2] = ReadADC(LowPin);		//Measure voltage at the suspected source
+		//If it is a normally on MOSFET or JFET has adcv[1]> adcv[0]
+		if(adcv[2]>(adcv[1]+100)) {
+			//Measure voltage at the gate, to distinguish between the MOSFET and JFET
+			GPIOB->ODR = 0;
+			GPIOB->DDR = (1 << LowPin);//Low-Pin sets to ground
+			GPIOB->CR1 = (1 << LowPin);//!!! all others to HiZ
+			tmpval = (HighPin * 2 + 1);
+			GPIOC->DDR |= (1 << tmpval);
+			GPIOC->CR1 |= (1 << tmpval);//!!!
+			GPIOC->ODR |= (1 << tmpval);//High-Pin output with R_L to Vcc
+			if(WatchADC(TristatePin, 800, 1, 20) > 800) {	//Gate uber R_H: MOSFET ladt auf, JFET klemmt
+				tc->PartFound = PART_FET;			//N-Kanal-MOSFET
+				tc->PartMode = PART_MODE_N_D_MOS;	//Verarmungs-MOSFET
+			} else {	//JFET (pn-Ubergang zwischen G und S leitet)
+				tc->PartFound = PART_FET;			//N-Kanal-JFET
+				tc->PartMode = PART_MODE_N_JFET;
+			}
+			tc->b = TristatePin;
+			tc->c = HighPin;
+			tc->e = LowPin;
+		}
+		
+		//Test for P-JFET, or even conducting P-MOSFET
+		//Low-Pin (suspected drain) firmly on earth, tri-pin (suspected Gate) is still about to R_H Plus
+		GPIOB->ODR = 0;
+		GPIOB->CR1 = (1 << LowPin);//!!! all others to HiZ
+		GPIOB->DDR = (1 << LowPin);
+		tmpval = (HighPin * 2 + 1);
+		GPIOC->DDR |= (1 << tmpval);
+		GPIOC->CR1 |= (1 << tmpval);//!!!
+		GPIOC->ODR |= (1 << tmpval); //High-pin to Vcc via R_L
+		delay(MS(20));
+		adcv[1] = ReadADC(HighPin);		//Measure voltage at the suspected source
+		GPIOC->ODR = (1 << tmpval);  //Tristate Pin (suspected Gate) via R_H to ground
+		delay(MS(20));
+		adcv[2] = ReadADC(HighPin);		//Measure voltage at the suspected source
+		//If it is a normally on MOSFET P-or P-JFET, had adcv [0]> adcv [1] are
+		if(adcv[1]>(adcv[2]+100)) {
+			//Measure voltage at the gate, to distinguish between the MOSFET and JFET
+			GPIOB->ODR = (1 << HighPin);
+			GPIOB->CR1 = (1 << HighPin);//!!! all others to HiZ
+			GPIOB->DDR = (1 << HighPin);//High-pin firmly Plus
+			if(WatchADC(TristatePin, 200, 0, 20) < 200) {	//Gate uber R_H: MOSFET entladt, JFET klemmt
+				tc->PartFound = PART_FET;			//P-Kanal-MOSFET
+				tc->PartMode = PART_MODE_P_D_MOS;	//Verarmungs-MOSFET
+			} else {	//JFET (pn-Ubergang zwischen G und S leitet)
+				tc->PartFound = PART_FET;			//P-Kanal-JFET
+				tc->PartMode = PART_MODE_P_JFET;
+			}
+			tc->b = TristatePin;
+			tc->c = LowPin;
+			tc->e = HighPin;
+		}
+	}
+#endif
+	//Pins erneut setzen
+	tmpval = (LowPin * 2 + 1);
+	GPIOC->DDR = (1 << tmpval);
+	GPIOC->CR1 = (1 << tmpval); //!!! all others to HiZ
+	GPIOC->ODR = 0;//Low-Pin auf Ausgang und uber R_L auf Masse
+	GPIOB->DDR = (1 << HighPin);
+	GPIOB->CR1 = (1 << HighPin);// !!!
+	GPIOB->ODR = (1 << HighPin);//High-Pin fest auf Vcc
+	Settle(5);
+	
+	if(adcv[0] < 200) {	//If the component is no continuity between HighPin and has LowPin
+		//Sperrstrom messen: Low-Pin uber R_H statt R_L auf Masse, High-Pin bleibt auf Vcc
+		GPIOC->DDR = (2 << tmpval);
+		GPIOC->CR1 = (2 << tmpval);
+		delay(LEAK_SETTLE);	//der Pin ladt sich uber R_H von fast 0 auf die Sperrstrom-Spannung um
+		tc->leakage[HighPin][LowPin] = LeakageCurrent(ReadADCLong(LowPin));
+		GPIOC->DDR = (1 << tmpval);	//Low-Pin wieder uber R_L auf Masse
+		GPIOC->CR1 = (1 << tmpval);
+#if TEST_BJT || TEST_FET
+		//Test auf pnp
+		tmpval2 = (TristatePin * 2 + 1);
+		GPIOC->DDR |= (1 << tmpval2);//Tristate-Pin uber R_L auf Masse, zum Test auf pnp
+		GPIOC->CR1 |= (1 << tmpval2);//!!!
+		if(WatchADC(LowPin, 700, 1, 2) > 700) {	//bis das Bauteil leitet, hochstens 2 ms
+			//Bauteil leitet => pnp-Transistor o.a.
+			//Basis und Kollektor uber R_L: Transistor ist ubersteuert, UCE(sat) zwischen High-Pin und Low-Pin
+			ReadADCScan(scan);
+			sat = (scan[HighPin] > scan[LowPin]) ? (scan[HighPin] - scan[LowPin]) : 0;
+			//Gain factor measured in both directions
+			GPIOC->DDR = (1 << tmpval);
+			GPIOC->CR1 = (1 << tmpval);
+			tmpval2++;
+			GPIOC->DDR |= (1 << tmpval2);
+			GPIOC->CR1 |= (1 << tmpval2);
+			delay(MS(10));
+			ReadADCPair(LowPin, TristatePin, &uc, &ub);	//collector and base voltage at the same instant
+			adcv[1] = uc;		//Low voltage on the pin (assumed collector)
+			adcv[2] = ub;		//Base voltage
+			//Prooven if test already run times
+			if((tc->PartFound == PART_TRANSISTOR) || (tc->PartFound == PART_FET)) tc->PartReady = 1;
+			tc->hfe[tc->PartReady] = adcv[1];
+			tc->uBE[tc->PartReady] = adcv[2];
+			tc->vcesat[tc->PartReady] = AdcToMv(sat);
+
+			if(tc->PartFound != PART_THYRISTOR) {
+				if(adcv[2] > 200) {
+					tc->PartFound = PART_TRANSISTOR;	//PNP transistor found (base is "up" solid)
+					tc->PartMode = PART_MODE_PNP;
+#if TEST_BJT
+					ReadFollower(tc, TristatePin, LowPin, HighPin);
+#endif
+				} else {
+					if(adcv[0] < 20) {	//Forward voltage in the off state is low enough? (otherwise D-mode FETs are mistakenly identified as E-mode)
+					 	tc->PartFound = PART_FET;			//P-channel MOSFET found (base / gate is not pulled "up")
+						tc->PartMode = PART_MODE_P_E_MOS;
+#if TEST_FET
+						tc->gthvoltage = GateThreshold(TristatePin, LowPin, 1);	//Gate-Schwellspannung
+#endif
+					}
+				}
+				tc->b = TristatePin;
+				tc->c = LowPin;
+				tc->e = HighPin;
+			}
+		}
+
+#endif
+
+#if TEST_BJT || TEST_FET || TEST_THYRISTOR
+		//Tristate (assumed basis) Plus, for testing on an npn
+		GPIOB->ODR = 0;  //Low-Pin fest auf Masse
+		tmpval = (TristatePin * 2 + 1);
+		tmpval2 = (HighPin * 2 + 1);
+		GPIOC->DDR = (1 << tmpval) | (1 << tmpval2);
+		GPIOC->CR1 = (1 << tmpval) | (1 << tmpval2);
+		GPIOC->ODR = (1 << tmpval) | (1 << tmpval2);//High-Pin und Tristate-Pin uber R_L auf Vcc
+		GPIOB->DDR = (1 << LowPin);
+		GPIOB->CR1 = (1 << LowPin);
+		if(WatchADC(HighPin, 500, 0, 10) < 500) {	//bis das Bauteil leitet, hochstens 10 ms
+			if(tc->PartReady==1) goto testend;
+			//Bauteil leitet => npn-Transistor o.a.
+			//Basis und Kollektor uber R_L: UCE(sat) fur den Fall, dass es ein Transistor ist
+			ReadADCScan(scan);
+			sat = (scan[HighPin] > scan[LowPin]) ? (scan[HighPin] - scan[LowPin]) : 0;
+
+#if TEST_THYRISTOR
+			//Test auf Thyristor:
+			//Gate entladen
+			
+			GPIOC->ODR = (1 << tmpval2);			//Tristate-Pin (Gate) uber R_L auf Masse
+			GPIOC->CR1 = (1 << tmpval2);
+			//Transistor und MOSFET sperren sofort, ein Thyristor bleibt das ganze Fenster gezundet
+			adcv[3] = WatchADC(HighPin, 500, 1, 1);	//Spannung am High-Pin (vermutete Anode)
+			GPIOC->DDR = (1 << tmpval2);			//Tristate-Pin (Gate) hochohmig
+			
+			GPIOC->ODR = 0;						//High-Pin (vermutete Anode) auf Masse
+			WaitADC(HighPin, 50, 0, EDGE_TIMEOUT);	//bis der Anodenstrom unterbrochen ist
+			delay(MS(1));						//Freiwerdezeit
+			GPIOC->ODR = (1 << tmpval2);			//High-Pin (vermutete Anode) wieder auf Plus
+			adcv[2] = WatchADC(HighPin, 900, 1, 5);	//Spannung am High-Pin (vermutete Anode) erneut messen
+			if((adcv[3] <= 500) && (adcv[2] > 900)) {	//Nach Abschalten des Haltestroms muss der Thyristor sperren
+				//war vor Abschaltung des Triggerstroms geschaltet und ist immer noch geschaltet obwohl Gate aus => Thyristor
+				uint16_t tmpAdc;
+				tc->PartFound = PART_THYRISTOR;
+				//Test auf Triac
+				GPIOC->DDR = 0;
+				GPIOC->CR1 = 0;
+				GPIOC->ODR = 0;
+				GPIOB->ODR = (1 << LowPin);	//Low-Pin fest auf Plus
+				GPIOB->CR1 = (1 << LowPin);
+				GPIOC->DDR = (1 << tmpval2);	//HighPin uber R_L auf Masse
+				GPIOC->CR1 = (1 << tmpval2);
+				tmpAdc = WaitADC(HighPin, 50, 0, EDGE_TIMEOUT);
+				if(tmpAdc > 50) goto savenresult;	//Spannung am High-Pin (vermuteter A2) messen; falls zu hoch: Bauteil leitet jetzt => kein Triac
+				GPIOC->DDR |= (1 << tmpval);	//Gate auch uber R_L auf Masse => Triac musste zunden
+				GPIOC->CR1 |= (1 << tmpval);
+				tmpAdc = WaitADC(HighPin, 150, 1, EDGE_TIMEOUT);
+				if(tmpAdc < 150) goto savenresult; //Bauteil leitet jetzt nicht => kein Triac => Abbruch
+				if(ReadADCBelow(TristatePin, 200, 0, 0)) goto savenresult; //Spannung am Tristate-Pin (vermutetes Gate) messen; Abbruch falls Spannung zu gering
+				GPIOC->DDR = (1 << tmpval2);	//TristatePin (Gate) wieder hochohmig
+				GPIOC->CR1 = (1 << tmpval2);
+				tmpAdc = WaitADC(HighPin, 150, 0, LATCH_WINDOW);
+				if(tmpAdc < 150) goto savenresult; //Bauteil leitet nach Abschalten des Gatestroms nicht mehr=> kein Triac => Abbruch
+				GPIOC->ODR = (1 << tmpval2);	//HighPin uber R_L auf Plus => Haltestrom aus
+				WaitADC(HighPin, 970, 1, EDGE_TIMEOUT);
+				delay(MS(1));				//Freiwerdezeit
+				GPIOC->ODR = 0;				//HighPin R_L over again on earth; Triac now had to block
+				tmpAdc = WaitADC(HighPin, 50, 0, EDGE_TIMEOUT);
+				if(tmpAdc > 50) goto savenresult;	//Spannung am High-Pin (vermuteter A2) messen; falls zu hoch: Bauteil leitet jetzt => kein Triac
+				tc->PartFound = PART_TRIAC;
+				tc->PartReady = 1;
+				goto savenresult;
+			}
+#endif
+			//Test auf Transistor oder MOSFET
+			tmpval++;
+			GPIOC->DDR |= (1 << tmpval);		//Tristate-Pin (Basis) auf Ausgang
+			GPIOC->CR1 |= (1 << tmpval);
+			GPIOC->ODR |= (1 << tmpval);		//Tristate-Pin (Basis) uber R_H auf Plus
+			delay(MS(50));
+			ReadADCPair(HighPin, TristatePin, &uc, &ub);	//Kollektor- und Basisspannung im selben Moment messen
+			adcv[1] = uc;		//Spannung am High-Pin (vermuteter Kollektor)
+			adcv[2] = ub;		//Basisspannung
+
+			if((tc->PartFound == PART_TRANSISTOR) || (tc->PartFound == PART_FET)) tc->PartReady = 1;	//prufen, ob Test schon mal gelaufen
+			tc->hfe[tc->PartReady] = 1023 - adcv[1];
+			tc->uBE[tc->PartReady] = 1023 - adcv[2];
+			tc->vcesat[tc->PartReady] = AdcToMv(sat);
+			if(adcv[2] < 500) {
+				tc->PartFound = PART_TRANSISTOR;	//NPN-Transistor gefunden (Basis wird "nach unten" gezogen)
+				tc->PartMode = PART_MODE_NPN;
+#if TEST_BJT
+				ReadFollower(tc, TristatePin, HighPin, LowPin);
+#endif
+			} else {
+				if(adcv[0] < 20) {	//Durchlassspannung im gesperrten Zustand gering genug? (sonst werden D-Mode-FETs falschlicherweise als E-Mode erkannt)
+					tc->PartFound = PART_FET;			//N-Kanal-MOSFET gefunden (Basis/Gate wird NICHT "nach unten" gezogen)
+					tc->PartMode = PART_MODE_N_E_MOS;
+#if TEST_FET
+					tc->gthvoltage = GateThreshold(TristatePin, HighPin, 0);	//Gate-Schwellspannung
+#endif
+				}
+			}
+#if TEST_THYRISTOR
+			savenresult:
+#endif
+			tc->b = TristatePin;
+			tc->c = HighPin;
+			tc->e = LowPin;
+		}
+#endif
+		GPIOB->DDR = 0;
+		GPIOB->CR1 = 0;
+		GPIOB->ODR = 0;
+		//Fertig
+	} else {	//Durchgang
+#if TEST_DIODE
+		//Test auf Diode
+		tmpval2 = (2<<(2*HighPin + 1));	//R_H
+		tmpval = (1<<(2*HighPin + 1));	//R_L
+		GPIOB->ODR = 0;
+		GPIOB->CR1 = (1 << LowPin);
+		GPIOB->DDR = (1 << LowPin);	//Low-Pin fest auf Masse, High-Pin ist noch uber R_L auf Vcc
+		DischargePin(TristatePin,1);	//Entladen fur P-Kanal-MOSFET
+		Settle(5);
+		adcv[0] = ReadADCDiff(HighPin, LowPin, 0);	//Durchlassspannung ohne den Offset am Low-Pin
+		GPIOC->DDR = tmpval2;	//High-Pin uber R_H auf Plus
+		GPIOC->CR1 = tmpval2;
+		GPIOC->ODR = tmpval2;
+		Settle(5);
+		adcv[2] = ReadADCDiffSync(HighPin, LowPin, 0);	//Durchlassspannung ohne den Offset am Low-Pin, R_H: uber eine Netzperiode
+		GPIOC->DDR = tmpval;	//High-Pin uber R_L auf Plus
+		GPIOC->CR1 = tmpval;
+		GPIOC->ODR = tmpval;
+		DischargePin(TristatePin,0);	//Entladen fur N-Kanal-MOSFET
+		Settle(5);
+		adcv[1] = ReadADCDiff(HighPin, LowPin, &ub);	//Durchlassspannung ohne den Offset am Low-Pin (ub)
+		GPIOC->DDR = tmpval2;	//High-Pin uber R_H  auf Plus
+		GPIOC->CR1 = tmpval2;
+		GPIOC->ODR = tmpval2;
+		Settle(5);
+		adcv[3] = ReadADCDiffSync(HighPin, LowPin, 0);	//Durchlassspannung ohne den Offset am Low-Pin, R_H: uber eine Netzperiode
+		/*Without unloading can cause false detections, because the gate of a MOSFET can still be charged.
+The additional measurement with the "big" resistance R_H is carried out to anti-parallel diode of
+Resistors to be able to distinguish.
+A diode has a forward current of relatively independent Durchlassspg.
+If the resistance is the voltage drop changes significantly (linear) with the flow.
+		*/
+		if(adcv[0] > adcv[1]) {
+			adcv[1] = adcv[0];	//the higher value wins
+			adcv[3] = adcv[2];
+		}
+
+		if((adcv[1] > 30) && (adcv[1] < 950)) { //Spannung liegt uber 0,15V und unter 4,64V => Ok
+			uint8_t i,j;
+			if((tc->PartFound == PART_NONE) || (tc->PartFound == PART_RESISTOR)) tc->PartFound = PART_DIODE;	//Diode nur angeben, wenn noch kein anderes Bauteil gefunden wurde. Sonst gabe es Probleme bei Transistoren mit Schutzdiode
+			tc->diodes[tc->NumOfDiodes].Anode = HighPin;
+			tc->diodes[tc->NumOfDiodes].Cathode = LowPin;
+			ClassifyDiode(&tc->diodes[tc->NumOfDiodes], adcv[1], adcv[3]);	//Uf, rd, n und LED-Farbe aus beiden Messpunkten
+#if TEST_NETWORK
+			//dritter Messpunkt fur den Serienwiderstand: auch der Low-Pin uber R_L, etwa halber Strom
+			GPIOB->DDR = 0;
+			GPIOB->CR1 = 0;
+			GPIOC->DDR = tmpval | (1 << (2*LowPin + 1));
+			GPIOC->CR1 = tmpval | (1 << (2*LowPin + 1));
+			GPIOC->ODR = tmpval;
+			Settle(5);
+			ReadADCPair(HighPin, LowPin, &uc, &ul);
+			FitSeries(&tc->diodes[tc->NumOfDiodes], adcv[1], ub, adcv[3], uc, ul);
+#endif
+			tc->NumOfDiodes++;
+			for(i=0;i<tc->NumOfDiodes;i++) {
+				if((tc->diodes[i].Anode == LowPin) && (tc->diodes[i].Cathode == HighPin)) {	//zwei antiparallele Dioden: Defekt oder Duo-LED
+					if((adcv[3]*64) < (adcv[1] / 5)) {	//Durchlassspannung fallt bei geringerem Teststrom stark ab => Defekt
+						if(i<tc->NumOfDiodes) {
+							for(j=i;j<(tc->NumOfDiodes-1);j++) {
+								tc->diodes[j] = tc->diodes[j+1];
+							}
+						}
+						tc->NumOfDiodes -= 2;
+					}
+				}
+			}
+		}
+#endif
+	}
+
+#if TEST_RESISTOR
+	//Test auf Widerstand
+	//Spannung am Widerstand und am Low-Pin jeweils im selben Scan, kein eigener Offset-Durchlauf
+	tmpval = (HighPin * 2 + 1);
+	GPIOB->ODR = 0;
+	GPIOB->CR1 = (1 << LowPin);
+	GPIOB->DDR = (1 << LowPin);	//Low-Pin fest auf Masse
+	GPIOC->DDR = (1 << tmpval);	//High-Pin uber R_L auf Plus
+	GPIOC->CR1 = (1 << tmpval);
+	GPIOC->ODR = (1 << tmpval);
+	delay(MS(1));
+	adcv[0] = ReadADCDiff(HighPin, LowPin, &ul);
+	adcv[2] = ul;
+	GPIOC->DDR = (2 << tmpval);	//High-Pin uber R_H auf Plus
+	GPIOC->CR1 = (2 << tmpval);
+	GPIOC->ODR = (2 << tmpval);
+	Settle(5);
+	adcv[1] = ReadADCDiffSync(HighPin, LowPin, &ul);	//R_H: uber eine Netzperiode, gegen Brummen
+	adcv[3] = ul;
+
+	//Spannungsabfall am Plus-Treiber: sein Ausgangswiderstand teilt sich die ubrige Spannung mit R_L, bei R_H ist er vernachlassigbar
+	if(adcv[0] + adcv[2] < 1023) adcv[2] += FixMul(1023 - adcv[0] - adcv[2], Q_PORT_RL);
+#if TEST_NETWORK
+	tc->netv[HighPin][LowPin][0] = adcv[0];	//fur FitNetwork, beide Polaritaten
+	tc->netv[HighPin][LowPin][1] = adcv[1];
+	tc->neto[HighPin][LowPin][0] = (uint8_t)adcv[2];
+	tc->neto[HighPin][LowPin][1] = (uint8_t)adcv[3];
+#endif
+
+	if((adcv[0] < (adcv[2] + 900)) && (adcv[1] > (adcv[3] + 20))) goto testend; 	//Spannung fallt bei geringem Teststrom nicht weit genug ab (ohne Unterlauf, adcv[3] kann grosser als adcv[1] sein)
+	if(((adcv[1] * 32) / 31) < adcv[0]) {	//Abfallende Spannung fallt bei geringerem Teststrom stark ab und es besteht kein "Beinahe-Kurzschluss" => Widerstand
+		if((tc->PartFound == PART_DIODE) || (tc->PartFound == PART_NONE) || (tc->PartFound == PART_RESISTOR)) {
+			if((tc->tmpPartFound == PART_RESISTOR) && (tc->ra == LowPin) && (tc->rb == HighPin)) {
+				/* Das Bauteil wurde schon einmal mit umgekehrter Polaritat getestet.
+				Jetzt beide Ergebnisse miteinander vergleichen. Wenn sie recht ahnlich sind,
+				handelt es sich (hochstwahrscheinlich) um einen Widerstand. */
+				if(!((((adcv[0] + 100) * 6) >= ((tc->rv[0] + 100) * 5)) && (((tc->rv[0] + 100) * 6) >= ((adcv[0] + 100) * 5)) && (((adcv[1] + 100) * 6) >= ((tc->rv[1] + 100) * 5)) && (((tc->rv[1] + 100) * 6) >= ((adcv[1] + 100) * 5)))) {
+					//min. 20% Abweichung => kein Widerstand
+					tc->tmpPartFound = PART_NONE;
+					goto testend;
+				}
+				tc->PartFound = PART_RESISTOR;
+#if TEST_NETWORK
+				ReadRC(tc, HighPin, LowPin, adcv);	//R || C: Ladezeit uber R_H, korrigiert adcv[1] bei langsamem Einschwingen
+#endif
+			}
+			tc->rv[0] = adcv[0];
+			tc->rv[1] = adcv[1];
+
+			tc->radcmax[0] = 1023 - adcv[2];	//Spannung am Low-Pin ist nicht ganz Null, sondern rund 0,1V (im selben Scan gemessen), und der Plus-Treiber verliert etwas. Der dadurch entstehende Fehler wird hier kompensiert
+			tc->radcmax[1] = 1023 - adcv[3];
+			tc->ra = HighPin;
+			tc->rb = LowPin;
+			tc->tmpPartFound = PART_RESISTOR;
+		}
+	}
+#endif
+	testend:
+	GPIOB->DDR = 0;
+	GPIOB->CR1 = 0;
+	GPIOB->ODR = 0;
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+	GPIOC->ODR = 0;
+}
+
+#ifdef USE_FULL_ASSERT
+void assert_failed(uint8_t* file, uint32_t line)
+{ 
+  while (1)
+  {
+  }
+}
+#endif
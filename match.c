@@ -0,0 +1,236 @@
+#include "stm8s.h"
+#include "match.h"
+
+#if MATCH
+
+#define DUKR_KEY1 0xAE
+#define DUKR_KEY2 0x56
+#define UNLOCK_TIMEOUT 100
+
+#define MATCH_MAGIC 0x5A	//layout of the stored batch, change with MatchEntry; erased EEPROM reads 0
+
+@eeprom MatchEntry gList[MATCH_MAX];	//in the order of measurement, part n is gList[n-1]
+@eeprom uint8_t gMagic;					//MATCH_MAGIC once InitMatch has set up the batch
+@eeprom uint8_t gCount;
+@eeprom uint8_t gEmpty;					//tests with an empty socket in a row
+@eeprom uint8_t gPair[2];
+@eeprom uint16_t gPairD;
+@eeprom uint8_t gQuad[4];
+@eeprom uint16_t gQuadD;
+
+static uint8_t gIndex[MATCH_MAX];	//entries sorted by class and key
+
+//a write to @eeprom variables needs the unlocked data EEPROM
+static void Unlock(void)
+{
+	uint8_t n = UNLOCK_TIMEOUT;
+
+	FLASH->DUKR = DUKR_KEY1;
+	FLASH->DUKR = DUKR_KEY2;
+	while (!(FLASH->IAPSR & FLASH_IAPSR_DUL) && --n)
+		;
+}
+
+static uint8_t Less(uint8_t a, uint8_t b)
+{
+	if (gList[a].Class != gList[b].Class)
+	{
+		return (gList[a].Class < gList[b].Class);
+	}
+
+	return (gList[a].Key < gList[b].Key);
+}
+
+//inserts entry e into the sorted index of the first n entries, returns its position
+static uint8_t Insert(uint8_t e, uint8_t n)
+{
+	uint8_t lo = 0, hi = n, mid;
+
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if (Less(gIndex[mid], e))
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	for (hi = n; hi > lo; hi--)
+	{
+		gIndex[hi] = gIndex[hi - 1];
+	}
+	gIndex[lo] = e;
+
+	return lo;
+}
+
+static uint16_t Distance(uint8_t a, uint8_t b)
+{
+	uint16_t d = 0;
+	uint16_t ka = gList[a].Key, kb = gList[b].Key;
+	uint16_t ua = gList[a].Aux, ub = gList[b].Aux;
+	uint32_t t;
+
+	if (gList[a].Class < MATCH_DIODE)	//hFE relative
+	{
+		if (ka < kb)
+		{
+			d = (uint16_t)(((uint32_t)(kb - ka) * 1000) / kb);
+		}
+		else if (ka > kb)
+		{
+			d = (uint16_t)(((uint32_t)(ka - kb) * 1000) / ka);
+		}
+	}
+	t = (uint32_t)((ua > ub) ? (ua - ub) : (ub - ua)) * MATCH_MV_WEIGHT + d;
+
+	return (t > 0xFFFF) ? 0xFFFF : (uint16_t)t;
+}
+
+//largest distance within the 4 index positions from p on, 0xFFFF if not one class
+static uint16_t QuadSpread(uint8_t p, uint8_t n)
+{
+	uint8_t i, j;
+	uint16_t d, max = 0;
+
+	if ((p + 4 > n) || (gList[gIndex[p]].Class != gList[gIndex[p + 3]].Class))
+	{
+		return 0xFFFF;
+	}
+	for (i = p; i < p + 3; i++)
+	{
+		for (j = i + 1; j < p + 4; j++)
+		{
+			d = Distance(gIndex[i], gIndex[j]);
+			if (d > max)
+			{
+				max = d;
+			}
+		}
+	}
+
+	return max;
+}
+
+//sorted index of the stored batch, about 10 ms for MATCH_MAX parts
+void InitMatch(void)
+{
+	uint8_t i;
+
+	if ((gMagic != MATCH_MAGIC) || (gCount > MATCH_MAX))	//EEPROM erased, other layout or damaged
+	{
+		Unlock();
+		gCount = 0;
+		gEmpty = 0;
+		gPairD = gQuadD = 0xFFFF;
+		gMagic = MATCH_MAGIC;	//last: an init cut short by power off is repeated
+	}
+	for (i = 0; i < gCount; i++)
+	{
+		Insert(i, i);
+	}
+}
+
+/*
+Stores the new part and updates the best pair and quad incrementally:
+the pair of the new part with its closest partner (one pass over its class)
+and the four quads of index neighbours that contain it.
+A full batch keeps its parts, the new one is only compared.
+*/
+void MatchAdd(uint8_t cls, uint16_t key, uint16_t aux, MatchResult *res)
+{
+	uint8_t e, i, p, n = gCount;
+	uint16_t d;
+
+	Unlock();
+	gEmpty = 0;
+	res->Num = 0;
+	res->Partner = 0;
+	res->PartnerD = 0xFFFF;
+
+	e = (n < MATCH_MAX) ? n : (MATCH_MAX - 1);	//full: last slot as scratch, not counted
+	gList[e].Key = key;
+	gList[e].Aux = aux;
+	gList[e].Class = cls;
+
+	for (i = 0; i < n; i++)
+	{
+		if ((i != e) && (gList[i].Class == cls))
+		{
+			d = Distance(e, i);
+			if (d < res->PartnerD)
+			{
+				res->PartnerD = d;
+				res->Partner = i + 1;
+			}
+		}
+	}
+
+	if (n < MATCH_MAX)
+	{
+		res->Num = e + 1;
+		p = Insert(e, n);
+		gCount = ++n;
+		if (res->Partner && (res->PartnerD < gPairD))
+		{
+			gPair[0] = res->Partner;
+			gPair[1] = res->Num;
+			gPairD = res->PartnerD;
+		}
+		for (i = (p > 3) ? (p - 3) : 0; i <= p; i++)
+		{
+			d = QuadSpread(i, n);
+			if (d < gQuadD)
+			{
+				gQuadD = d;
+				gQuad[0] = gIndex[i] + 1;
+				gQuad[1] = gIndex[i + 1] + 1;
+				gQuad[2] = gIndex[i + 2] + 1;
+				gQuad[3] = gIndex[i + 3] + 1;
+			}
+		}
+	}
+
+	res->Pair[0] = gPair[0];
+	res->Pair[1] = gPair[1];
+	res->PairD = gPairD;
+	for (i = 0; i < 4; i++)
+	{
+		res->Quad[i] = gQuad[i];
+	}
+	res->QuadD = gQuadD;
+}
+
+/*
+Test without a stored part. Open: the socket was empty, the second such test
+in a row clears the batch; any other result ends the row.
+Returns 1 if a new batch was started.
+*/
+uint8_t MatchEmpty(uint8_t Open)
+{
+	if (!Open)
+	{
+		if (gEmpty)		//no EEPROM write in the common case
+		{
+			Unlock();
+			gEmpty = 0;
+		}
+		return 0;
+	}
+	Unlock();
+	if (gEmpty == 0)
+	{
+		gEmpty = 1;
+		return 0;
+	}
+	gCount = 0;
+	gPairD = gQuadD = 0xFFFF;
+	gEmpty = 0;
+
+	return 1;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef __MATCH_H__
+#define __MATCH_H__
+
+/*
+Matching mode: every measured part gets the next number and is stored in the
+data EEPROM, so a batch survives the power cycle between two parts.
+A sorted index in RAM (class, key) is built at startup; after each insertion
+the closest partner of the new part and the best pair and quad so far are
+reported. Two tests in a row that find the socket empty (CONTACT_OPEN) start
+a new batch; a short, a contact fault or an unknown part ends the row.
+*/
+#ifndef MATCH
+#define MATCH 0				//1 = matching mode
+#endif
+
+#define MATCH_MAX 100		//parts per batch, 5 bytes EEPROM each
+
+#define MATCH_NPN 1			//classes, only parts of one class are matched
+#define MATCH_PNP 2
+#define MATCH_DIODE 3		//+ Kind of the diode (DIODE_...)
+
+/*
+Distance of two parts in per mille of the collector/diode current:
+relative hFE difference plus MATCH_MV_WEIGHT per mV of UBE/Uf difference
+(dI/I = dU/UT, 1 mV = 38 per mille at room temperature).
+*/
+#define MATCH_MV_WEIGHT 38
+
+typedef struct
+{
+	uint16_t Key;		//sort key: hFE for transistors, Uf in mV for diodes
+	uint16_t Aux;		//UBE or Uf in mV
+	uint8_t Class;		//MATCH_..., 0 = free
+} MatchEntry;
+
+typedef struct
+{
+	uint8_t Num;		//number of the new part, 0 = not stored
+	uint8_t Partner;	//closest part of the same class, 0 = none
+	uint16_t PartnerD;	//distance in per mille
+	uint8_t Pair[2];	//best pair so far
+	uint16_t PairD;
+	uint8_t Quad[4];	//best quad so far (4 neighbours in the index)
+	uint16_t QuadD;		//largest distance within the quad
+} MatchResult;
+
+#if MATCH
+void InitMatch(void);
+
+void MatchAdd(uint8_t cls, uint16_t key, uint16_t aux, MatchResult *res);
+
+uint8_t MatchEmpty(uint8_t Open);
+#endif
+
+#endif
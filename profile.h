@@ -0,0 +1,51 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+/*
+Test profiles: the part classes CheckPins looks for.
+Disabled classes are removed at compile time together with their probe
+sequences, settle waits, display code and strings.
+The profile is selected here or with the compiler option -dTEST_PROFILE=n
+in the project settings (C Compiler, Preprocessor Definitions).
+*/
+#define PROFILE_FULL 0			//all part classes
+#define PROFILE_DIODES 1		//diodes, LEDs, Zener diodes and resistors
+#define PROFILE_BJT 2			//bipolar transistors (diodes for B-E voltage and protection diode)
+#define PROFILE_FET 3			//MOSFETs and JFETs
+
+#ifndef TEST_PROFILE
+#define TEST_PROFILE PROFILE_FULL
+#endif
+
+#if TEST_PROFILE == PROFILE_DIODES
+#define TEST_DIODE 1
+#define TEST_RESISTOR 1
+#define TEST_BJT 0
+#define TEST_FET 0
+#define TEST_THYRISTOR 0
+#elif TEST_PROFILE == PROFILE_BJT
+#define TEST_DIODE 1
+#define TEST_RESISTOR 0
+#define TEST_BJT 1
+#define TEST_FET 0
+#define TEST_THYRISTOR 0
+#elif TEST_PROFILE == PROFILE_FET
+#define TEST_DIODE 1
+#define TEST_RESISTOR 0
+#define TEST_BJT 0
+#define TEST_FET 1
+#define TEST_THYRISTOR 0
+#else
+#define TEST_DIODE 1
+#define TEST_RESISTOR 1
+#define TEST_BJT 1
+#define TEST_FET 1
+#define TEST_THYRISTOR 1
+#endif
+
+#define TEST_NETWORK (TEST_DIODE && TEST_RESISTOR)	//composite two-terminal networks (D||R, D+R, R||C)
+#define TEST_RECOVERY TEST_DIODE	//reverse recovery of single diodes: standard, fast, ultrafast, Schottky
+
+#define FP_CACHE 4		//fingerprints of recent part types (TestPart), 0 = always the full search
+
+#endif
@@ -0,0 +1,41 @@
+#include "stm8s.h"
+#include "serial.h"
+#include "trace.h"
+#include "tester.h"
+#include "curve.h"
+
+#if TRACE || CURVE
+
+void SerialOpen(uint16_t baud)
+{
+	uint16_t div = (uint16_t)(F_CPU / baud);
+
+	UART2->BRR2 = (uint8_t)(((div >> 8) & 0xF0) | (div & 0x0F));	//BRR2 first
+	UART2->BRR1 = (uint8_t)(div >> 4);
+	UART2->CR2 = UART2_CR2_TEN;
+}
+
+void SerialSend(uint8_t c)
+{
+	while (!(UART2->SR & UART2_SR_TXE))
+		;
+	UART2->DR = c;
+}
+
+void SerialHex(uint8_t b)
+{
+	static const char hex[] = "0123456789ABCDEF";
+
+	SerialSend(hex[b >> 4]);
+	SerialSend(hex[b & 15]);
+}
+
+//waits for the last stop bit
+void SerialClose(void)
+{
+	while (!(UART2->SR & UART2_SR_TC))
+		;
+	UART2->CR2 = 0;
+}
+
+#endif
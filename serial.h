@@ -0,0 +1,18 @@
+#ifndef __SERIAL_H__
+#define __SERIAL_H__
+
+/*
+Transmit only UART2 on PD5 for the dumps of trace.c and curve.c.
+PD5 is also a data line of the LCD; while E is low the LCD ignores it, so
+a dump is only made when the display is idle. SerialClose switches the UART
+off, PD5 is a GPIO again.
+*/
+void SerialOpen(uint16_t baud);
+
+void SerialSend(uint8_t c);
+
+void SerialHex(uint8_t b);
+
+void SerialClose(void);
+
+#endif
@@ -0,0 +1,50 @@
+#include "stm8s.h"
+#include "delay.h"
+#include "socket.h"
+
+/*
+All sockets are discharged after power up; the first SelectSocket
+only needs the settle time of the mux.
+*/
+void InitSockets(void)
+{
+#if SOCKETS > 1
+	MUX_PORT->ODR &= (uint8_t)(~MUX_MASK);
+	MUX_PORT->DDR |= MUX_MASK;
+	MUX_PORT->CR1 |= MUX_MASK;
+
+	DIS_PORT->ODR |= DIS_MASK;
+	DIS_PORT->DDR |= DIS_MASK;
+	DIS_PORT->CR1 |= DIS_MASK;
+#endif
+}
+
+/*
+Connects socket s to TP1..TP3.
+The discharge of a socket is only released while it is selected, so
+the other sockets are discharged during the whole test of socket s.
+ScanSockets (main.c) selects every socket twice, first for a short look
+and then for the test; a charged socket is tested last, its capacitor
+drains over the discharge line while the others are tested.
+*/
+void SelectSocket(uint8_t s)
+{
+#if SOCKETS > 1
+	GPIOC->DDR = 0;		//R_L/R_H off, no current through the mux while switching
+	GPIOC->CR1 = 0;
+	DIS_PORT->ODR |= DIS_MASK;
+	MUX_PORT->ODR = (uint8_t)((MUX_PORT->ODR & ~MUX_MASK) | (s << MUX_SHIFT));
+	DIS_PORT->ODR &= (uint8_t)(~(1 << (s + DIS_SHIFT)));
+	delay(MUX_SETTLE);
+#endif
+}
+
+//all sockets discharged, e.g. before a part is changed
+void ReleaseSockets(void)
+{
+#if SOCKETS > 1
+	GPIOC->DDR = 0;
+	GPIOC->CR1 = 0;
+	DIS_PORT->ODR |= DIS_MASK;
+#endif
+}
@@ -0,0 +1,31 @@
+#ifndef __SOCKET_H__
+#define __SOCKET_H__
+
+/*
+Several test sockets behind an analog multiplexer.
+The mux connects the three probe lines of the selected socket to TP1..TP3,
+so the R_L/R_H pins (GPIOC) and the ADC channels (GPIOB) are the same for
+every socket. Each socket has its own discharge line, which shorts its probe
+lines to ground (e.g. with a small N-MOSFET array) while it is not selected.
+*/
+#ifndef SOCKETS
+#define SOCKETS 1			//number of sockets (1 = no multiplexer fitted)
+#endif
+
+#define MUX_PORT GPIOG		//address lines of the mux
+#define MUX_SHIFT 0			//PG0, PG1: up to 4 sockets
+#define MUX_MASK (3 << MUX_SHIFT)
+
+#define DIS_PORT GPIOA		//discharge lines, active high
+#define DIS_SHIFT 3			//PA3..PA6 for socket 0..3
+#define DIS_MASK (((1 << SOCKETS) - 1) << DIS_SHIFT)
+
+#define MUX_SETTLE US(100)	//switching time of the mux and charge sharing of the probe lines
+
+void InitSockets(void);
+
+void SelectSocket(uint8_t s);
+
+void ReleaseSockets(void);
+
+#endif
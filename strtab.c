@@ -0,0 +1,138 @@
+/*
+Generated by tools/mkstrings.py from strings.txt, do not edit.
+Packed LCD texts: StrData holds the texts in the order of their ids, each
+ends with 0. Codes from 0x80 are pairs from StrPair.
+*/
+#include "stm8s.h"
+#include "profile.h"
+#include "match.h"
+#include "strtab.h"
+
+const uint8_t StrPair[STR_PAIRS][2] = {
+	{':', ' '},	//0x80 ": "
+	{'s', 't'},	//0x81 "st"
+	{'o', 'r'},	//0x82 "or"
+	{'C', '='},	//0x83 "C="
+	{'a', 'r'},	//0x84 "ar"
+	{'d', ' '},	//0x85 "d "
+	{' ', 'd'},	//0x86 " d"
+	{' ', 'u'},	//0x87 " u"
+	{'1', '='},	//0x88 "1="
+	{'2', '='},	//0x89 "2="
+	{'D', 'S'},	//0x8A "DS"
+	{'I', 'r'},	//0x8B "Ir"
+	{'c', 'h'},	//0x8C "ch"
+	{'d', 'e'},	//0x8D "de"
+	{'e', 0x85},	//0x8E "ed "
+	{'g', 0x8E},	//0x8F "ged "
+	{'i', 'o'},	//0x90 "io"
+	{'p', 0x84},	//0x91 "par"
+	{'r', 'i'},	//0x92 "ri"
+	{0x90, 0x8D},	//0x93 "iode"
+};
+
+const uint8_t StrData[] = {
+	'N', 'o', ',', 0x87, 'n', 'k', 'n', 'o', 'w', 'n', ',', ' ', 0x82, 0x00,	//S_TestFailed1 "No, unknown, or"
+	'd', 'a', 'm', 'a', 0x8F, 0x00,	//S_TestFailed2 "damaged "
+	0x91, 't', 0x00,	//S_Bauteil "part"
+	0x87, 'n', 'k', 'n', 'o', 'w', 'n', 0x00,	//S_Unknown " unknown"
+	'D', 0x93, 0x80, 0x00,	//S_Diode "Diode: "
+	'D', 'o', 'u', 'b', 'l', 'e', 0x86, 0x93, ' ', 0x00,	//S_DualDiode "Double diode "
+	'2', 0x86, 0x93, 's', 0x00,	//S_TwoDiodes "2 diodes"
+	'a', 'n', 't', 'i', '-', 0x91, 'a', 'l', 'l', 'e', 'l', 0x00,	//S_Antiparallel "anti-parallel"
+	's', 'e', 0x92, 'a', 'l', ' ', 'A', '=', 0x00,	//S_InSeries "serial A="
+	';', 'C', 0x88, 0x00,	//S_K1 ";C1="
+	';', 'C', 0x89, 0x00,	//S_K2 ";C2="
+	';', 0x83, 0x00,	//S_NextK ";C="
+	0x83, 0x00,	//S_K "C="
+	0x82, 0x86, 'a', 'm', 'a', 0x8F, 0x00,	//S_OrBroken "or damaged "
+	';', 'A', 0x88, 0x00,	//S_A1 ";A1="
+	';', 'A', 0x89, 0x00,	//S_A2 ";A2="
+	' ', 0x83, 0x00,	//S_GateCap " C="
+	'U', 'f', '=', 0x00,	//S_Uf "Uf="
+	'm', 'V', 0x00,	//S_mV "mV"
+	'A', '=', 0x00,	//S_Anode "A="
+	'C', 'A', 0x00,	//S_CA "CA"
+	'C', 'C', 0x00,	//S_CC "CC"
+	'T', 'i', 'm', 'e', 'o', 'u', 't', '!', 0x00,	//S_TestTimedOut "Timeout!"
+	'S', 'o', 'c', 'k', 'e', 't', ' ', 0x00,	//S_SocketStr "Socket "
+	0x8B, '=', 0x00,	//S_Ir "Ir="
+	0x8B, 0x88, 0x00,	//S_Ir1 "Ir1="
+	0x8B, 0x89, 0x00,	//S_Ir2 "Ir2="
+	'L', 'E', 'D', 0x80, 0x00,	//S_Led "LED: "
+	'Z', 'e', 'n', 'e', 'r', 0x80, 0x00,	//S_Zener "Zener: "
+	'U', 'z', '=', 0x00,	//S_Uz "Uz="
+	'r', 'd', '=', 0x00,	//S_rd "rd="
+	'R', ' ', 'n', '=', 0x00,	//S_Ideality "R n="
+	0x00,	//S_TimeoutKind ""
+	'A', 'D', 'C', 0x00,	//(S_TimeoutKind + 1) "ADC"
+	'D', 'e', 'a', 'd', 'l', 'i', 'n', 'e', 0x00,	//(S_TimeoutKind + 2) "Deadline"
+	'W', 'a', 't', 0x8C, 'd', 'o', 'g', 0x00,	//(S_TimeoutKind + 3) "Watchdog"
+	' ', 0x81, 'e', 'p', ' ', 0x00,	//S_StepStr " step "
+	'C', 'h', 0x84, 0x8F, 0x91, 't', 0x00,	//S_ChargedStr "Charged part"
+	'U', '0', '=', 0x00,	//S_StartStr "U0="
+	0x00,	//S_LedColor ""
+	' ', 'I', 'R', 0x00,	//(S_LedColor + 1) " IR"
+	' ', 'r', 'e', 'd', 0x00,	//(S_LedColor + 2) " red"
+	' ', 'g', 'r', 'e', 'e', 'n', 0x00,	//(S_LedColor + 3) " green"
+	' ', 'b', 'l', 'u', 'e', 0x00,	//(S_LedColor + 4) " blue"
+	' ', 'w', 'h', 'i', 't', 'e', 0x00,	//(S_LedColor + 5) " white"
+	'C', 'h', 'e', 'c', 'k', ' ', 'c', 'o', 'n', 't', 'a', 'c', 't', 0x00,	//S_ContactStr "Check contact"
+	'S', 'h', 0x82, 't', ' ', 'c', 'i', 'r', 'c', 'u', 'i', 't', 0x00,	//S_ShortStr "Short circuit"
+	'p', 'i', 'n', 0x00,	//S_PinStr "pin"
+#if TEST_RECOVERY
+	'S', 0x8C, 'o', 't', 't', 'k', 'y', ' ', 0x00,	//S_Schottky "Schottky "
+	0x00,	//S_RecoveryKind ""
+	' ', 0x81, 'd', 0x00,	//(S_RecoveryKind + 1) " std"
+	' ', 'f', 'a', 0x81, 0x00,	//(S_RecoveryKind + 2) " fast"
+	0x87, 'f', 'a', 0x81, 0x00,	//(S_RecoveryKind + 3) " ufast"
+	0x00,	//(S_RecoveryKind + 4) ""
+#endif
+#if TEST_THYRISTOR
+	'G', 'A', 0x83, 0x00,	//S_GAK "GAC="
+	'T', 0x92, 'a', 'c', 0x00,	//S_Triac "Triac"
+	'T', 'h', 'y', 0x92, 0x81, 0x82, 0x00,	//S_Thyristor "Thyristor"
+	'G', '=', 0x00,	//S_Gate "G="
+	'I', 'g', '<', 0x00,	//S_IgMax "Ig<"
+	'I', 'g', '>', 0x00,	//S_IgMin "Ig>"
+	'I', 'H', '<', 0x00,	//S_IhMax "IH<"
+	'V', 'g', '=', 0x00,	//S_vg "Vg="
+#endif
+#if TEST_RESISTOR
+	'R', 'e', 's', 'i', 0x81, 0x82, 0x80, 0x00,	//S_Resistor "Resistor: "
+#endif
+#if TEST_FET
+	'-', 'M', 'O', 'S', 0x00,	//S_mosfet "-MOS"
+	'-', 'E', 0x00,	//S_emode "-E"
+	'-', 'D', 0x00,	//S_dmode "-D"
+	'-', 'J', 'F', 'E', 'T', 0x00,	//S_jfet "-JFET"
+	'G', 0x8A, '=', 0x00,	//S_gds "GDS="
+	'V', 't', '=', 0x00,	//S_vt "Vt="
+	'I', 0x8A, 'S', '=', 0x00,	//S_Idss "IDSS="
+	'I', 0x8A, 'S', '>', 0x00,	//S_IdssMin "IDSS>"
+	'V', 'p', '=', 0x00,	//S_vp "Vp="
+#endif
+#if TEST_BJT
+	'h', 'F', 'E', '=', 0x00,	//S_hfestr "hFE="
+	'N', 'P', 'N', 0x00,	//S_NPN "NPN"
+	'P', 'N', 'P', 0x00,	//S_PNP "PNP"
+	' ', 'B', '=', 0x00,	//S_bstr " B="
+	';', 'E', '=', 0x00,	//S_estr ";E="
+	' ', 'V', 's', '=', 0x00,	//S_Vsat " Vs="
+#endif
+#if TEST_NETWORK
+	'D', '|', '|', 'R', 0x80, 0x00,	//S_NetRD "D||R: "
+	'+', 'R', 0x80, 0x00,	//S_NetDS "+R: "
+	'R', '|', '|', 'C', 0x80, 0x00,	//S_NetRC "R||C: "
+	' ', 'R', '=', 0x00,	//S_Rstr " R="
+	'R', '=', 0x00,	//S_RValue "R="
+	0x08, 0x00,	//S_NetDiode "\d"
+	'L', 'E', 'D', 0x00,	//S_NetLed "LED"
+#endif
+#if MATCH
+	'P', 'a', 'i', 'r', ' ', 0x00,	//S_PairStr "Pair "
+	'Q', 'u', 'a', 0x85, 0x00,	//S_QuadStr "Quad "
+	'N', 'e', 'w', ' ', 'b', 'a', 't', 0x8C, 0x00,	//S_NewBatch "New batch"
+	' ', '~', '#', 0x00,	//S_MatchNear " ~#"
+#endif
+};
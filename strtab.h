@@ -0,0 +1,107 @@
+/*
+Generated by tools/mkstrings.py from strings.txt, do not edit.
+Ids of the LCD texts for Say(), see text.h.
+*/
+#ifndef __STRTAB_H__
+#define __STRTAB_H__
+
+#define S_TestFailed1 0
+#define S_TestFailed2 1
+#define S_Bauteil 2
+#define S_Unknown 3
+#define S_Diode 4
+#define S_DualDiode 5
+#define S_TwoDiodes 6
+#define S_Antiparallel 7
+#define S_InSeries 8
+#define S_K1 9
+#define S_K2 10
+#define S_NextK 11
+#define S_K 12
+#define S_OrBroken 13
+#define S_A1 14
+#define S_A2 15
+#define S_GateCap 16
+#define S_Uf 17
+#define S_mV 18
+#define S_Anode 19
+#define S_CA 20
+#define S_CC 21
+#define S_TestTimedOut 22
+#define S_SocketStr 23
+#define S_Ir 24
+#define S_Ir1 25
+#define S_Ir2 26
+#define S_Led 27
+#define S_Zener 28
+#define S_Uz 29
+#define S_rd 30
+#define S_Ideality 31
+#define S_TimeoutKind 32
+#define S_StepStr 36
+#define S_ChargedStr 37
+#define S_StartStr 38
+#define S_LedColor 39
+#define S_ContactStr 45
+#define S_ShortStr 46
+#define S_PinStr 47
+
+#define STR_ID_TEST_RECOVERY 48
+#define S_Schottky (STR_ID_TEST_RECOVERY + 0)
+#define S_RecoveryKind (STR_ID_TEST_RECOVERY + 1)
+
+#define STR_ID_TEST_THYRISTOR (STR_ID_TEST_RECOVERY + (TEST_RECOVERY ? 6 : 0))
+#define S_GAK (STR_ID_TEST_THYRISTOR + 0)
+#define S_Triac (STR_ID_TEST_THYRISTOR + 1)
+#define S_Thyristor (STR_ID_TEST_THYRISTOR + 2)
+#define S_Gate (STR_ID_TEST_THYRISTOR + 3)
+#define S_IgMax (STR_ID_TEST_THYRISTOR + 4)
+#define S_IgMin (STR_ID_TEST_THYRISTOR + 5)
+#define S_IhMax (STR_ID_TEST_THYRISTOR + 6)
+#define S_vg (STR_ID_TEST_THYRISTOR + 7)
+
+#define STR_ID_TEST_RESISTOR (STR_ID_TEST_THYRISTOR + (TEST_THYRISTOR ? 8 : 0))
+#define S_Resistor (STR_ID_TEST_RESISTOR + 0)
+
+#define STR_ID_TEST_FET (STR_ID_TEST_RESISTOR + (TEST_RESISTOR ? 1 : 0))
+#define S_mosfet (STR_ID_TEST_FET + 0)
+#define S_emode (STR_ID_TEST_FET + 1)
+#define S_dmode (STR_ID_TEST_FET + 2)
+#define S_jfet (STR_ID_TEST_FET + 3)
+#define S_gds (STR_ID_TEST_FET + 4)
+#define S_vt (STR_ID_TEST_FET + 5)
+#define S_Idss (STR_ID_TEST_FET + 6)
+#define S_IdssMin (STR_ID_TEST_FET + 7)
+#define S_vp (STR_ID_TEST_FET + 8)
+
+#define STR_ID_TEST_BJT (STR_ID_TEST_FET + (TEST_FET ? 9 : 0))
+#define S_hfestr (STR_ID_TEST_BJT + 0)
+#define S_NPN (STR_ID_TEST_BJT + 1)
+#define S_PNP (STR_ID_TEST_BJT + 2)
+#define S_bstr (STR_ID_TEST_BJT + 3)
+#define S_estr (STR_ID_TEST_BJT + 4)
+#define S_Vsat (STR_ID_TEST_BJT + 5)
+#define S_cstr S_NextK
+
+#define STR_ID_TEST_NETWORK (STR_ID_TEST_BJT + (TEST_BJT ? 6 : 0))
+#define S_NetRD (STR_ID_TEST_NETWORK + 0)
+#define S_NetDS (STR_ID_TEST_NETWORK + 1)
+#define S_NetRC (STR_ID_TEST_NETWORK + 2)
+#define S_Rstr (STR_ID_TEST_NETWORK + 3)
+#define S_RValue (STR_ID_TEST_NETWORK + 4)
+#define S_NetDiode (STR_ID_TEST_NETWORK + 5)
+#define S_NetLed (STR_ID_TEST_NETWORK + 6)
+
+#define STR_ID_MATCH (STR_ID_TEST_NETWORK + (TEST_NETWORK ? 7 : 0))
+#define S_PairStr (STR_ID_MATCH + 0)
+#define S_QuadStr (STR_ID_MATCH + 1)
+#define S_NewBatch (STR_ID_MATCH + 2)
+#define S_MatchNear (STR_ID_MATCH + 3)
+
+#define STR_PAIRS 20
+#define STR_DEPTH 4	//nesting of the pairs, stack of Say()
+
+extern const uint8_t StrPair[STR_PAIRS][2];
+extern const uint8_t StrData[];
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef __TESTER_H__
+#define __TESTER_H__
+
+#define PART_NONE 0
+#define PART_DIODE 1
+#define PART_TRANSISTOR 2
+#define PART_FET 3
+#define PART_TRIAC 4
+#define PART_THYRISTOR 5
+#define PART_RESISTOR 6
+#define PART_CAPACITOR 7
+#define PART_NETWORK 8		//Zweipol aus mehreren Bauteilen, Art in NetKind
+
+#define PART_MODE_N_E_MOS 1
+#define PART_MODE_P_E_MOS 2
+#define PART_MODE_N_D_MOS 3
+#define PART_MODE_P_D_MOS 4
+#define PART_MODE_N_JFET 5
+#define PART_MODE_P_JFET 6
+
+#define PART_MODE_NPN 1
+#define PART_MODE_PNP 2
+
+#define DIODE_PLAIN 0	//Si, Schottky, Ge
+#define DIODE_LED_IR 1
+#define DIODE_LED_RED 2
+#define DIODE_LED_GREEN 3
+#define DIODE_LED_BLUE 4
+#define DIODE_LED_WHITE 5
+#define DIODE_ZENER 6	//weicher Knick, Durchbruch einer Z-Diode unter 4,6V
+
+#define TIMEOUT_NONE 0
+#define TIMEOUT_ADC 1		//ein ADC-Wandlungsende kam nicht
+#define TIMEOUT_DEADLINE 2	//TEST_DEADLINE uberschritten
+#define TIMEOUT_WDT 3		//der vorige Test wurde vom IWDG abgebrochen
+
+#define STEP_FET 6			//Schritte von TestPart, 0..5 sind die Pin-Permutationen
+#define STEP_THYRISTOR 7
+#define STEP_RECOVERY 9		//8 war ReadTransistor, jetzt in CheckPins
+
+#define NET_RD 1			//Diode parallel zu einem Widerstand
+#define NET_DS 2			//Diode oder LED mit Serienwiderstand
+#define NET_RC 3			//Widerstand parallel zu einem Kondensator
+
+#define NET_RS_MIN 100		//kleinster Serienwiderstand in Ohm, darunter ist es der Bahnwiderstand der Diode
+
+#define CHARGE_NONE 0		//Pins beim Start entladen
+#define CHARGE_FOUND 1		//Kondensator war geladen, wurde uber R_L entladen
+#define CHARGE_HELD 2		//Spannung blieb uber DISCHARGE_MAX_MS, kein Test
+
+#define DISCHARGE_LEVEL 10		//ADC: alle Pins unter etwa 50 mV gelten als entladen
+#define DISCHARGE_FAST_MS 10	//langer dauert es nur mit einem geladenen Kondensator
+#define DISCHARGE_MAX_MS 2000	//470 uF uber R_L von 5 V auf 50 mV: 1,5 s
+#define DISCHARGE_EDGE 50		//WaitADC-Wandlungen fur ein Gate, etwa 1 ms
+#define GATE_SAMPLES 8			//Messungen der Gate-Schwellspannung, gemittelt
+#define GATE_DRAIN 512			//ADC: der MOSFET schaltet, wenn der Drain uber R_L die halbe Spannung erreicht
+
+#define RR_NONE 0			//Sperrverzogerung nicht gemessen (keine einzelne Si-Diode)
+#define RR_STANDARD 1		//Gleichrichterdiode
+#define RR_FAST 2
+#define RR_ULTRAFAST 3
+#define RR_SCHOTTKY 4		//keine Speicherzeit und kleine Durchlassspannung
+
+#define RR_ULTRA_NS ((unsigned int)(1000000000UL / F_CPU))	//Speicherzeit bei IF = IR (etwa 3 mA uber R_L), darunter ultraschnell bzw. Schottky: ein Punktabstand von SweepADC (500 ns), kurzer ist von Null nicht zu unterscheiden
+#define RR_FAST_NS 1000		//darunter schnell, daruber Standard; die Messung ist auf etwa +-0,5 us genau (ReadRecovery)
+#define RR_SCHOTTKY_MV 450	//Uf einer Schottky-Diode bei R_L-Strom
+
+#define CONTACT_NONE 0		//Vorprufung ohne Befund
+#define CONTACT_OPEN 1		//kein Pin hat Verbindung: Sockel leer oder kein Kontakt
+#define CONTACT_SHORT 2		//Kurzschluss zwischen zwei Pins
+#define CONTACT_PIN 3		//ein Pin ohne Verbindung und die Suche fand nichts: Kontakt prufen
+
+#define CONTACT_SETTLE_MS 1		//je Messung der Kurzschlussprufung
+#define CONTACT_OPEN_US 100		//je Messung der Prufung auf freie Pins: 7 Tau von R_H mit etwa 30 pF Sockel und Mux, aber nur 2 Tau mit 100 pF
+#define CONTACT_OPEN_LSB 20		//ein Pin uber R_H bleibt so nah am Potential von R_H: nichts unter etwa 20 MOhm und kein Kondensator uber etwa 50 pF
+#define CONTACT_SHORT_LSB 3		//Spannung uber dem Paar bei R_L-Strom (7 mA): unter etwa 2 Ohm
+#define CONTACT_SHORT_MS 10		//zweite Messung bei Kurzschluss-Verdacht, ein grosser Elko steigt bis dahin daruber
+
+#define HFE2_UCE_MIN 41		//ADC: UCE des Emitterfolgers (ReadFollower) mindestens 200 mV, sonst gesattigt
+
+#define ZENER_IDEALITY 50	//ab n = 5 keine LED mehr, sondern Z-Diode
+
+struct Diode {
+	uint8_t Anode : 2;
+	uint8_t Cathode : 2;
+	uint8_t Kind : 4;		//DIODE_...
+	uint8_t Ideality;		//Idealitatsfaktor n * 10 aus beiden Messpunkten
+	int Voltage;			//Durchlassspannung in mV mit R_L (einige mA)
+	unsigned int Rd;		//differentieller Widerstand in Ohm bei R_L-Strom
+	unsigned int Leakage;	//Sperrstrom in nA
+	unsigned int Rs;		//Serienwiderstand in Ohm aus dem 3-Punkt-Fit, 0 = keiner
+	int Uj;					//Durchlassspannung ohne den Spannungsabfall an Rs in mV
+};
+
+/*
+Complete state of one test run. Everything CheckPins finds and the display code
+shows lives here, so a run can be measured into one record while another is shown.
+Pins and flags are bit fields, the STM8 has only 2 KB RAM.
+*/
+typedef struct {
+	struct Diode diodes[6];
+	unsigned int leakage[3][3];	//Sperrstrom in nA fur jede gesperrte Pin-Kombination [HighPin][LowPin]
+	unsigned int hfe[2];		//Verstarkungsfaktoren
+	unsigned int uBE[2];		//B-E-Spannung fur Transistoren
+	unsigned int ileak[2];		//Leckstrome in nA: ICEO bzw. IDSS, ICBO
+	unsigned int vcesat[2];		//UCE(sat) in mV mit R_L an Basis und Kollektor, je Orientierung
+	unsigned int follow[2][2];	//Emitterfolger mit R_L an der Basis, je Orientierung: Spannung an R_L von Emitter und Basis, ADC * 16
+	unsigned int hfe2;			//hFE als Emitterfolger mit R_L an der Basis (einige mA)
+	unsigned int ic2;			//Kollektorstrom dabei in uA
+	unsigned int rv[2];			//Spannungsabfall am Widerstand
+	unsigned int radcmax[2];	//Maximal erreichbarer ADC-Wert (geringer als 1023, weil Spannung am Low-Pin bei Widerstandsmessung uber Null liegt)
+	unsigned long rvalue;		//Widerstand in Ohm, bei rk in 100 Ohm
+	unsigned int gthvoltage;	//Gate-Schwellspannung in mV, 0 = nicht gemessen
+	unsigned int idss;			//Drainstrom bei UGS=0 in uA (Verarmungs-FETs)
+	unsigned int upinch;		//Abschnurspannung in mV
+	unsigned int igt;			//Gate-Zundstrom in uA (obere Grenze) fur Thyristor/Triac
+	unsigned int ugt;			//Gate-Spannung beim Zunden in mV
+	unsigned int ihold;			//Haltestrom in uA (obere Grenze), 0 = nicht gemessen
+	unsigned int netv[3][3][2];	//Spannung uber dem Bauteil mit R_L/R_H [HighPin][LowPin] aus dem Widerstandstest
+	uint8_t neto[3][3][2];		//Spannung am Low-Pin dabei plus Abfall am Plus-Treiber
+	unsigned long netr;			//Widerstand im Netzwerk in Ohm
+	unsigned long netc;			//Kapazitat parallel zum Widerstand in pF
+	uint16_t ucharge;			//hochste Pin-Spannung beim Start in mV, bei Charged
+	unsigned int trr;			//Speicherzeit der einzelnen Diode in ns, bei trrlimit untere Grenze
+	uint8_t NetKind;			//NET_..., gultig bei PART_NETWORK
+	uint8_t NumOfDiodes;
+	uint8_t Perms;				//Pin-Kombinationen aus PreCheck fur MeasurePart
+	uint8_t TimeoutStep;		//Schritt, nach dem der Test abgebrochen wurde (STEP_...)
+	uint8_t PartFound : 4;		//das gefundene Bauteil
+	uint8_t tmpPartFound : 4;
+	uint8_t PartMode : 4;
+	uint8_t PartReady : 1;		//Bauteil fertig erkannt
+	uint8_t idsslimited : 1;	//Drain bei der IDSS-Messung nicht in Sattigung, Strom durch R_L begrenzt
+	uint8_t rk : 1;				//rvalue mit R_H gemessen, in 100 Ohm
+	uint8_t igtlimit : 1;		//zundet auch mit R_L nicht, igt ist untere Grenze
+	uint8_t trrlimit : 1;		//sperrt im Messfenster nicht, trr ist untere Grenze
+	uint8_t Recovery : 3;		//RR_..., Art der Diode nach Speicherzeit und Uf
+	uint8_t b : 2;				//Anschlusse des Transistors
+	uint8_t c : 2;
+	uint8_t e : 2;
+	uint8_t ra : 2;				//Widerstands-Pins
+	uint8_t rb : 2;
+	uint8_t ca : 2;				//Kondensator-Pins
+	uint8_t cb : 2;
+	uint8_t Timeout : 2;		//TIMEOUT_..., Test abgebrochen, die Messwerte sind ungultig
+	uint8_t Charged : 2;		//CHARGE_..., Zustand beim Start des Tests
+	uint8_t Contact : 2;		//CONTACT_..., Befund der Vorprufung
+	uint8_t ContactPins : 3;	//betroffene Pins als Bitmaske (1 << TPx)
+} TestContext;
+
+void ClearContext(TestContext *tc);
+
+#endif
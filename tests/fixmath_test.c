@@ -0,0 +1,251 @@
+/*
+Host test of fixmath.c against double precision: the Q16 constants of
+fixmath.h, FixMul over the input range of every constant up to the edge
+where v * q leaves 32 bit, FixDiv over the quotients of the firmware and
+every divisor, Log2Q4 from 1 to 0xFFFFFFFF and FixSqrt.
+Prints the largest error found for each and fails if a documented bound
+does not hold.
+*/
+#include <stdio.h>
+#include <math.h>
+#include "stm8s.h"
+#include "fixmath.h"
+
+#define LOG2_STEP 977	//Log2Q4 above 2^20: every LOG2_STEP-th value plus the powers of two and their neighbours
+#define LOG2_ERR (1 / 32.0 + 1 / 1000.0)	//error bound of Log2Q4 (fixmath.c)
+#define DIV_N_MAX 0x7FFFFFFFUL	//largest dividend of FixDiv
+
+static const struct
+{
+	const char *name;
+	uint32_t q;
+	double k;			//exact factor: the constant is q / 2^16
+	uint16_t range;		//largest input of the firmware (ADC: 1023, ReadADCLong: 1023 * 16)
+} gConst[] =
+{
+	{"Q_MV", Q_MV, 5000.0 / 1023, 1023},
+	{"Q_UA_RL", Q_UA_RL, 4888.0 / RL_OHM, 1023},
+	{"Q_UA_RH", Q_UA_RH, 4888.0 / (RH_100 * 100.0), 1023},
+	{"Q_NA_RH", Q_NA_RH, 48880.0 / RH_100, 1023},
+	{"Q_NA_LEAK", Q_NA_LEAK, 3055.0 / RH_100, 1023 * 16},
+	{"Q_PORT_RL", Q_PORT_RL, (double)PORT_OHM / (RL_OHM + PORT_OHM), 1023},
+	{"1.0", 1UL << 16, 1.0, 65535},
+	{"0.5", 1UL << 15, 0.5, 65535}
+};
+
+static uint8_t fail;
+
+static void Fail(const char *what, double got, double want)
+{
+	printf("FAIL: %s: %.4f, expected %.4f\n", what, got, want);
+	fail = 1;
+}
+
+/*
+FixMul truncates q and the product, so the result is never above v * k
+and below it by less than 1 + v / 2^16 (fixmath.c).
+*/
+static void TestFixMul(void)
+{
+	uint8_t c;
+	uint32_t v, vmax;
+	double ref, err, worst;
+	char what[48];
+
+	for (c = 0; c < sizeof(gConst) / sizeof(gConst[0]); c++)
+	{
+		ref = gConst[c].k * 65536;
+		if ((gConst[c].q > ref) || (gConst[c].q <= ref - 1))
+		{
+			Fail(gConst[c].name, gConst[c].q, floor(ref));
+		}
+
+		vmax = 0xFFFFFFFFUL / gConst[c].q;
+		if (vmax > 65535)
+		{
+			vmax = 65535;
+		}
+		if (vmax < gConst[c].range)
+		{
+			sprintf(what, "%s: v * q overflows below the range", gConst[c].name);
+			Fail(what, vmax, gConst[c].range);
+		}
+
+		worst = 0;
+		for (v = 0; v <= vmax; v++)
+		{
+			ref = v * gConst[c].k;
+			err = ref - FixMul((uint16_t)v, gConst[c].q);
+			if ((err < 0) || (err >= 1 + v / 65536.0) || (ref > 65535.0))
+			{
+				sprintf(what, "FixMul(%lu, %s)", (unsigned long)v, gConst[c].name);
+				Fail(what, FixMul((uint16_t)v, gConst[c].q), ref);
+				break;
+			}
+			if (err > worst)
+			{
+				worst = err;
+			}
+		}
+		printf("%-10s q = %7lu, FixMul up to v = %5lu: error %.3f\n",
+			gConst[c].name, (unsigned long)gConst[c].q, (unsigned long)vmax, worst);
+	}
+
+	if (RH_RL_RATIO != (uint32_t)(RH_100 * 100.0 / RL_OHM))
+	{
+		Fail("RH_RL_RATIO", RH_RL_RATIO, RH_100 * 100.0 / RL_OHM);
+	}
+}
+
+//FixDiv(n, d) is below n / d by less than n / d / 2^13 + 2 (fixmath.c)
+static uint8_t CheckDiv(uint32_t n, uint16_t d, double *worst)
+{
+	double ref, err;
+	char what[40];
+
+	ref = (double)n / d;
+	err = ref - FixDiv(n, d);
+	if ((err < 0) || (err >= ref / 8192 + 2))
+	{
+		sprintf(what, "FixDiv(%lu, %u)", (unsigned long)n, d);
+		Fail(what, FixDiv(n, d), ref);
+		return 0;
+	}
+	err /= ref / 8192 + 2;
+	if (err > *worst)
+	{
+		*worst = err;
+	}
+
+	return 1;
+}
+
+/*
+The quotients of the firmware exhaustively: ResistorValue R_x * U / (Umax - U)
+and the hFE U_RL * RH_RL_RATIO / U_RH, then every divisor with dividends
+spread up to DIV_N_MAX.
+*/
+static void TestDiv(void)
+{
+	uint32_t a, n;
+	uint16_t d;
+	double worst = 0;
+
+	for (a = 1; a <= 1023; a++)
+	{
+		for (d = 1; d <= 1023; d++)
+		{
+			if (!CheckDiv(a * RL_OHM, d, &worst) || !CheckDiv(a * RH_100, d, &worst)
+				|| !CheckDiv(a * RH_RL_RATIO, d, &worst))
+			{
+				return;
+			}
+		}
+	}
+	for (d = 1; d; d++)
+	{
+		for (n = d; n <= DIV_N_MAX - (DIV_N_MAX >> 6); n += (n >> 6) + 1)
+		{
+			if (!CheckDiv(n - 1, d, &worst) || !CheckDiv(n, d, &worst))
+			{
+				return;
+			}
+		}
+		if (!CheckDiv(DIV_N_MAX, d, &worst))
+		{
+			return;
+		}
+	}
+	if (FixDiv(1, 0) != 0xFFFFFFFFUL)
+	{
+		Fail("FixDiv(1, 0)", FixDiv(1, 0), 0xFFFFFFFFUL);
+	}
+	printf("FixDiv n < 2^31, d 1 .. 65535: error %.3f of the bound\n", worst);
+}
+
+//Log2Q4 is within LOG2_ERR of log2(x), exact at the powers of two
+static double CheckLog2(uint32_t x, double worst)
+{
+	double err;
+	char what[32];
+
+	err = fabs(Log2Q4(x) / 16.0 - log2(x));
+	if ((err > LOG2_ERR) || (!(x & (x - 1)) && err))
+	{
+		sprintf(what, "Log2Q4(%lu)", (unsigned long)x);
+		Fail(what, Log2Q4(x) / 16.0, log2(x));
+	}
+
+	return (err > worst) ? err : worst;
+}
+
+static void TestLog2(void)
+{
+	uint32_t x;
+	uint8_t k;
+	double worst = 0;
+
+	for (x = 1; x <= (1UL << 20); x++)
+	{
+		worst = CheckLog2(x, worst);
+	}
+	for (x = (1UL << 20); x < 0xFFFFFFFFUL - LOG2_STEP; x += LOG2_STEP)
+	{
+		worst = CheckLog2(x, worst);
+	}
+	for (k = 1; k < 32; k++)
+	{
+		worst = CheckLog2((1UL << k) - 1, worst);
+		worst = CheckLog2(1UL << k, worst);
+		worst = CheckLog2((1UL << k) + 1, worst);
+	}
+	worst = CheckLog2(0xFFFFFFFFUL, worst);
+	printf("Log2Q4 1 .. 0xFFFFFFFF: error %.5f (bound %.5f)\n", worst, LOG2_ERR);
+}
+
+//FixSqrt(x) is r, 0 on a failure
+static uint8_t CheckSqrt(uint32_t x, uint32_t r)
+{
+	char what[32];
+
+	if (FixSqrt(x) != r)
+	{
+		sprintf(what, "FixSqrt(%lu)", (unsigned long)x);
+		Fail(what, FixSqrt(x), r);
+		return 0;
+	}
+
+	return 1;
+}
+
+//FixSqrt is floor(sqrt(x)): exact at every square, the value below the next one and in between
+static void TestSqrt(void)
+{
+	uint32_t r, d;
+
+	for (r = 0; r <= 0xFFFF; r++)
+	{
+		for (d = 0; d < 2 * r; d += (r > 16) ? r / 8 : 1)
+		{
+			if (!CheckSqrt(r * r + d, r))
+			{
+				return;
+			}
+		}
+		if (!CheckSqrt(r * r + 2 * r, r))
+		{
+			return;
+		}
+	}
+	printf("FixSqrt 0 .. 0xFFFFFFFF: exact\n");
+}
+
+int main(void)
+{
+	TestFixMul();
+	TestDiv();
+	TestLog2();
+	TestSqrt();
+
+	return fail;
+}
@@ -0,0 +1,856 @@
+#include <math.h>
+#include <string.h>
+#include "stm8s.h"
+#include "stm8s_adc1.h"
+#include "socket.h"
+#include "fixmath.h"
+#include "watchdog.h"
+#include "HD44780.h"
+#include "hw.h"
+
+#define NS_PER_TICK ((1000000000ULL << TICK_SHIFT) / F_CPU)
+#define POLL_NS 2000		//one poll of a timer or flag register
+#define VT 0.02585			//thermal voltage at room temperature
+
+#define PORT_MUX 6			//MUX_PORT = GPIOG, DIS_PORT = GPIOA (socket.h)
+#define PORT_DIS 0
+#define PORT_LCD 3			//GPIOD: RS = PD2, E = PD3, data PD4..PD7 (main.c)
+#define LCD_RS 0x04
+#define LCD_E 0x08
+
+HwPart HwSocket[HW_SOCKETS];
+uint64_t HwNs;
+unsigned int HwErrors;
+uint64_t HwHeld[HW_SOCKETS];
+FILE *HwUart;
+
+TIM1_TypeDef HostTIM1;
+IWDG_TypeDef HostIWDG;
+RST_TypeDef HostRST;
+FLASH_TypeDef HostFLASH;
+
+static GPIO_TypeDef gPort[7];
+static ADC1_TypeDef gADC;
+static TIM2_TypeDef gTIM2;
+static UART2_TypeDef gUART;
+
+static struct
+{
+	uint8_t ch;				//channel, last channel of a scan
+	uint8_t div;			//fADC = F_CPU / div
+	uint8_t scan;
+	uint8_t trig;			//started by TIM1 TRGO
+	uint8_t awd;			//channel watched by the analog watchdog, 0xFF = none
+	uint16_t hi, lo;
+	uint16_t value;
+	uint16_t buf[10];
+} gConv;
+
+static struct
+{
+	uint8_t mux;			//last address seen
+	uint8_t dis;			//last discharge lines seen
+	uint64_t since[HW_SOCKETS];	//start of the discharge
+} gMux;
+
+static struct
+{
+	uint8_t key[7];			//pin state of the last solution
+	double v[3];
+} gNet;
+
+static struct
+{
+	uint64_t ns;			//time of the last update of the capacitors (Charge)
+	uint8_t key[7];			//pin state of the Thevenin equivalent
+	const HwElement *e;		//and its capacitor
+	double r, vth;
+	double at;				//capacitor voltage the equivalent was taken at
+	double q;				//its voltage in the last solution (gNet)
+} gCharge;
+
+#define CHARGE_STEP 1e-3	//V, a change of the capacitor below that keeps the solution
+#define CHARGE_SPAN 0.1		//V, largest move on one Thevenin equivalent (clamps and junctions are not linear)
+
+static struct
+{
+	uint8_t mode8;			//still in 8 bit mode after power up
+	uint8_t high;			//high nibble of a 4 bit transfer is pending
+	uint8_t nibble;
+	uint8_t cgram;
+	uint8_t addr;
+	uint8_t shift;
+	uint8_t e;
+	char ddram[2][40];
+} gLcd;
+
+void HwReset(void)
+{
+	memset(gPort, 0, sizeof(gPort));
+	memset(&gADC, 0, sizeof(gADC));
+	memset(&gTIM2, 0, sizeof(gTIM2));
+	memset(&gUART, 0, sizeof(gUART));
+	memset(&HostTIM1, 0, sizeof(HostTIM1));
+	memset(&gConv, 0, sizeof(gConv));
+	memset(&gNet, 0xFF, sizeof(gNet.key));
+	memset(&gLcd, 0, sizeof(gLcd));
+	memset(gLcd.ddram, ' ', sizeof(gLcd.ddram));
+	gLcd.mode8 = 1;
+	gConv.awd = 0xFF;
+	gMux.mux = 0;
+	gMux.dis = 0;
+	memset(&gCharge, 0, sizeof(gCharge));
+	HwNs = 0;
+	HwErrors = 0;
+}
+
+//--- time
+
+void delay(unsigned int del)
+{
+	//inverse of US(): 4 cycles per loop
+	HwNs += ((uint64_t)del + 1) * 4 * 1000000000ULL / F_CPU;
+}
+
+/*
+Reading CNTRH latches CNTRL (Ticks): an access right after the one before,
+with no other time in between, is taken as the read of CNTRL and gets the
+low byte of the first, so a carry between the two reads does not tear the count.
+*/
+TIM2_TypeDef *HostTIM2(void)
+{
+	static uint64_t last;
+	static uint16_t latch;
+	uint16_t t;
+
+	HwNs += POLL_NS;
+	t = (uint16_t)(HwNs / NS_PER_TICK);
+	gTIM2.CNTRH = (uint8_t)(t >> 8);
+	gTIM2.CNTRL = (uint8_t)((HwNs == last + POLL_NS) ? latch : t);
+	latch = t;
+	last = HwNs;
+
+	return &gTIM2;
+}
+
+//--- probe network
+
+static uint8_t Selected(void)
+{
+#if SOCKETS > 1
+	return (uint8_t)((gPort[PORT_MUX].ODR & MUX_MASK) >> MUX_SHIFT);
+#else
+	return 0;
+#endif
+}
+
+static uint8_t Discharged(uint8_t s)
+{
+#if SOCKETS > 1
+	return (gPort[PORT_DIS].ODR >> (s + DIS_SHIFT)) & 1;
+#else
+	(void)s;
+	return 0;
+#endif
+}
+
+//drain current of a MOSFET at vgs and vds >= 0, square law
+static double Channel(const HwElement *e, double vgs, double vds)
+{
+	double ov = vgs - e->v1;
+
+	if (ov <= 0)
+	{
+		return 0;
+	}
+	if (vds >= ov)
+	{
+		return e->v2 / 2 * ov * ov;
+	}
+
+	return e->v2 * (ov - vds / 2) * vds;
+}
+
+//current into the terminal t of element e, node voltages v
+static double Current(const HwElement *e, uint8_t t, const double *v)
+{
+	double i, f, r;
+
+	switch (e->Kind)
+	{
+	case HW_R:
+		i = (v[e->a] - v[e->b]) / e->v1;
+		return (t == e->a) ? i : ((t == e->b) ? -i : 0);
+	case HW_Q:
+		i = (v[e->a] - v[e->b] - e->v2) / HW_R_ESR;
+		return (t == e->a) ? i : ((t == e->b) ? -i : 0);
+	case HW_D:
+		i = e->v1 * (exp((v[e->a] - v[e->b]) / (e->v2 * VT)) - 1);
+		return (t == e->a) ? i : ((t == e->b) ? -i : 0);
+	case HW_NPN:
+	case HW_PNP:
+		//Ebers-Moll, transport version, beta reverse 1
+		r = (e->Kind == HW_NPN) ? 1 : -1;
+		f = e->v1 * (exp(r * (v[e->a] - v[e->c]) / VT) - 1);
+		i = e->v1 * (exp(r * (v[e->a] - v[e->b]) / VT) - 1);
+		if (t == e->b)
+		{
+			return r * (f - 2 * i);
+		}
+		if (t == e->a)
+		{
+			return r * (f / e->v2 + i);
+		}
+		if (t == e->c)
+		{
+			return -r * (f - 2 * i + f / e->v2 + i);
+		}
+		break;
+	case HW_NMOS:
+	case HW_PMOS:
+		//symmetric channel: reversed, drain and source change roles; no gate current
+		r = (e->Kind == HW_NMOS) ? 1 : -1;
+		f = r * (v[e->b] - v[e->c]);
+		i = (f >= 0) ? Channel(e, r * (v[e->a] - v[e->c]), f) : -Channel(e, r * (v[e->a] - v[e->b]), -f);
+		return (t == e->b) ? r * i : ((t == e->c) ? -r * i : 0);
+	}
+
+	return 0;
+}
+
+//sum of the currents out of node n at the voltage x
+static double Residual(uint8_t n, double x, double *v, const double *g, const double *src, const HwPart *p)
+{
+	double i, keep = v[n];
+	uint8_t k;
+
+	v[n] = x;
+	i = g[n] * x - src[n];
+	for (k = 0; k < HW_ELEMENTS; k++)
+	{
+		i += Current(&p->e[k], n, v);
+	}
+	v[n] = keep;
+
+	return i;
+}
+
+//one pin: conductance and source current of a driver (push-pull or open drain)
+static void Drive(uint8_t n, uint8_t ddr, uint8_t cr1, uint8_t odr, uint8_t bit, double r, double *g, double *src)
+{
+	if (!(ddr & bit))
+	{
+		return;
+	}
+	if (odr & bit)
+	{
+		if (cr1 & bit)
+		{
+			g[n] += 1 / r;
+			src[n] += HW_VCC / r;
+		}
+	}
+	else
+	{
+		g[n] += 1 / r;
+	}
+}
+
+//pin state of the selected socket, a new one needs a new solution
+static void PinKey(uint8_t *key)
+{
+	uint8_t s = Selected();
+
+	key[0] = gPort[1].DDR & 7;
+	key[1] = gPort[1].ODR & 7;
+	key[2] = gPort[1].CR1 & 7;
+	key[3] = gPort[2].DDR;
+	key[4] = gPort[2].ODR;
+	key[5] = gPort[2].CR1;
+	key[6] = (uint8_t)(s | (Discharged(s) << 7));
+}
+
+/*
+A capacitor (HW_Q) or a conducting MOSFET ties two nodes by a few ohms, one
+node at a time they only creep: both are moved by the same step, found by
+bisection on the sum of their currents, in which the element cancels.
+Returns the step.
+*/
+static double Together(uint8_t na, uint8_t nb, double *v, const double *g, const double *src, const HwPart *p)
+{
+	double va = v[na], vb = v[nb], lo, hi, x, i;
+	uint8_t k, j;
+
+	lo = -fmin(va, vb);
+	hi = HW_VCC - fmax(va, vb);
+	for (j = 0; j < 48; j++)
+	{
+		x = (lo + hi) / 2;
+		v[na] = va + x;
+		v[nb] = vb + x;
+		i = g[na] * v[na] - src[na] + g[nb] * v[nb] - src[nb];
+		for (k = 0; k < HW_ELEMENTS; k++)
+		{
+			i += Current(&p->e[k], na, v) + Current(&p->e[k], nb, v);
+		}
+		if (i > 0)
+		{
+			hi = x;
+		}
+		else
+		{
+			lo = x;
+		}
+	}
+	x = (lo + hi) / 2;
+	v[na] = va + x;
+	v[nb] = vb + x;
+
+	return fabs(x);
+}
+
+/*
+DC solution of the selected socket. Every element current is monotonic in
+the voltage of each of its terminals, so the nodes are solved one after
+another by bisection (Gauss-Seidel), from the last solution, until nothing
+moves any more. Nodes tied by a capacitor or a MOSFET channel are also
+moved together.
+*/
+static void Solve(void)
+{
+	uint8_t key[7], s, n, k, it;
+	double g[3], src[3], lo, hi, x, d;
+	const HwPart *p;
+
+	s = Selected();
+	PinKey(key);
+	if (!memcmp(key, gNet.key, sizeof(key)))
+	{
+		return;
+	}
+	memcpy(gNet.key, key, sizeof(key));
+
+	p = &HwSocket[s % HW_SOCKETS];
+	for (n = 0; n < 3; n++)
+	{
+		g[n] = HW_G_PIN;
+		src[n] = 0;
+		Drive(n, key[0], key[2], key[1], 1 << n, HW_R_PORT, g, src);
+		Drive(n, key[3], key[5], key[4], 1 << (n * 2 + 1), RL_OHM + HW_R_PORT, g, src);
+		Drive(n, key[3], key[5], key[4], 2 << (n * 2 + 1), RH_100 * 100.0 + HW_R_PORT, g, src);
+		if (Discharged(s))
+		{
+			g[n] += 1 / HW_R_DIS;
+		}
+	}
+
+	for (it = 0; it < 200; it++)
+	{
+		d = 0;
+		for (n = 0; n < 3; n++)
+		{
+			lo = 0;
+			hi = HW_VCC;
+			if (Residual(n, lo, gNet.v, g, src, p) >= 0)
+			{
+				x = lo;
+			}
+			else if (Residual(n, hi, gNet.v, g, src, p) <= 0)
+			{
+				x = hi;
+			}
+			else
+			{
+				for (k = 0; k < 48; k++)
+				{
+					x = (lo + hi) / 2;
+					if (Residual(n, x, gNet.v, g, src, p) > 0)
+					{
+						hi = x;
+					}
+					else
+					{
+						lo = x;
+					}
+				}
+				x = (lo + hi) / 2;
+			}
+			d = fmax(d, fabs(x - gNet.v[n]));
+			gNet.v[n] = x;
+		}
+		for (k = 0; k < HW_ELEMENTS; k++)
+		{
+			if (p->e[k].Kind == HW_Q)
+			{
+				d = fmax(d, Together(p->e[k].a, p->e[k].b, gNet.v, g, src, p));
+			}
+			else if ((p->e[k].Kind == HW_NMOS) || (p->e[k].Kind == HW_PMOS))
+			{
+				d = fmax(d, Together(p->e[k].b, p->e[k].c, gNet.v, g, src, p));
+			}
+		}
+		if (d < 1e-7)
+		{
+			break;
+		}
+	}
+}
+
+/*
+Current into the plus terminal of the capacitor e of the selected socket at
+its voltage q, from a new solution of the network.
+*/
+static double Flow(HwElement *e, double q)
+{
+	double keep = e->v2, i;
+
+	e->v2 = q;
+	memset(gNet.key, 0xFF, sizeof(gNet.key));
+	Solve();
+	i = Current(e, e->a, gNet.v);
+	e->v2 = keep;
+	memset(gNet.key, 0xFF, sizeof(gNet.key));
+
+	return i;
+}
+
+/*
+The capacitors (HW_Q) of all sockets over the time since the last call, with
+the pin state of that time: the port access that calls this has not written
+yet. A discharged socket drains over its switches, the selected one over the
+network as seen from the capacitor (Thevenin equivalent from two solutions,
+kept until the pin state changes or the voltage moved by CHARGE_SPAN; a
+longer move is taken in steps of CHARGE_SPAN). The others keep their charge.
+*/
+static void Charge(void)
+{
+	uint64_t dt = HwNs - gCharge.ns;
+	uint8_t s, k, key[7];
+	HwElement *e;
+	double i0, i1, left, t, d;
+
+	gCharge.ns = HwNs;
+	if (!dt)
+	{
+		return;
+	}
+	for (s = 0; (s < SOCKETS) && (s < HW_SOCKETS); s++)
+	{
+		for (k = 0; k < HW_ELEMENTS; k++)
+		{
+			e = &HwSocket[s].e[k];
+			if (e->Kind != HW_Q)
+			{
+				continue;
+			}
+			if (Discharged(s))
+			{
+				e->v2 *= exp(-(double)dt * 1e-9 / (e->v1 * (2 * HW_R_DIS + HW_R_ESR)));
+			}
+			else if (s == Selected())
+			{
+				PinKey(key);
+				for (left = (double)dt * 1e-9; left > 0; left -= t)
+				{
+					if ((gCharge.e != e) || memcmp(key, gCharge.key, sizeof(key))
+						|| (fabs(e->v2 - gCharge.at) >= CHARGE_SPAN / 2))
+					{
+						i0 = Flow(e, e->v2);
+						d = (i0 >= 0) ? CHARGE_SPAN : -CHARGE_SPAN;	//the second solution on the side it moves to
+						i1 = Flow(e, e->v2 + d);
+						gCharge.e = e;
+						memcpy(gCharge.key, key, sizeof(key));
+						gCharge.r = ((i0 - i1) / d > 1e-11) ? d / (i0 - i1) : 0;	//0 = no path
+						gCharge.vth = e->v2 + i0 * gCharge.r;
+						gCharge.at = e->v2;
+					}
+					if (gCharge.r <= 0)
+					{
+						break;
+					}
+					t = left;
+					d = fabs(e->v2 - gCharge.vth);
+					if (d > CHARGE_SPAN)
+					{
+						d = -e->v1 * gCharge.r * log(1 - CHARGE_SPAN / d);	//time to move by CHARGE_SPAN
+						if (d < t)
+						{
+							t = d;
+						}
+					}
+					e->v2 = gCharge.vth + (e->v2 - gCharge.vth) * exp(-t / (e->v1 * gCharge.r));
+				}
+				if (fabs(e->v2 - gCharge.q) > CHARGE_STEP)
+				{
+					gCharge.q = e->v2;
+					memset(gNet.key, 0xFF, sizeof(gNet.key));
+				}
+			}
+		}
+	}
+}
+
+//gaussian noise with rms 1, fixed sequence so every run is the same
+static double Noise(void)
+{
+	static uint32_t seed = 1;
+	double u, w;
+
+	seed = seed * 1103515245 + 12345;
+	u = ((seed >> 8) + 0.5) / 16777216.0;
+	seed = seed * 1103515245 + 12345;
+	w = ((seed >> 8) + 0.5) / 16777216.0;
+
+	return sqrt(-2 * log(u)) * cos(2 * M_PI * w);
+}
+
+static uint16_t Sample(uint8_t ch)
+{
+	long v;
+
+	if (ch > 2)
+	{
+		return 0;
+	}
+#if SOCKETS > 1
+	if (Discharged(Selected()))
+	{
+		fprintf(stderr, "hw: conversion on the discharged socket %d\n", Selected());
+		HwErrors++;
+	}
+#endif
+	Charge();
+	Solve();
+	v = lround(gNet.v[ch] * 1023 / HW_VCC + HW_NOISE * Noise());
+
+	return (uint16_t)((v < 0) ? 0 : ((v > 1023) ? 1023 : v));
+}
+
+//--- GPIO
+
+/*
+Every port access checks the mux: when the address changed since the last
+access, R_L/R_H must be off and all sockets discharged (SelectSocket).
+Also keeps the start of the discharge per socket for HwHeld.
+*/
+GPIO_TypeDef *HostPort(uint8_t n)
+{
+#if SOCKETS > 1
+	uint8_t s, dis;
+#endif
+
+	Charge();
+#if SOCKETS > 1
+	if (Selected() != gMux.mux)
+	{
+		if (gPort[2].DDR || ((gPort[PORT_DIS].ODR & DIS_MASK) != DIS_MASK))
+		{
+			fprintf(stderr, "hw: mux switched to socket %d with probes connected\n", Selected());
+			HwErrors++;
+		}
+		gMux.mux = Selected();
+	}
+	dis = (uint8_t)((gPort[PORT_DIS].ODR & DIS_MASK) >> DIS_SHIFT);
+	for (s = 0; s < SOCKETS; s++)
+	{
+		if ((dis & ~gMux.dis) & (1 << s))
+		{
+			gMux.since[s] = HwNs;
+		}
+		if ((~dis & gMux.dis) & (1 << s))
+		{
+			HwHeld[s] = HwNs - gMux.since[s];
+		}
+	}
+	gMux.dis = dis;
+#endif
+
+	return &gPort[n];
+}
+
+static void LcdByte(uint8_t rs, uint8_t b)
+{
+	if (!rs)
+	{
+		if (b & 0x80)
+		{
+			gLcd.addr = b & 0x7F;
+			gLcd.cgram = 0;
+		}
+		else if (b & 0x40)
+		{
+			gLcd.cgram = 1;
+		}
+		else if ((b & 0xFC) == 0x18)
+		{
+			gLcd.shift++;
+		}
+		else if ((b & 0xFE) == 0x02)
+		{
+			gLcd.addr = 0;
+			gLcd.shift = 0;
+		}
+		else if (b == 0x01)
+		{
+			memset(gLcd.ddram, ' ', sizeof(gLcd.ddram));
+			gLcd.addr = 0;
+			gLcd.shift = 0;
+		}
+		return;
+	}
+	if (gLcd.cgram)
+	{
+		return;
+	}
+	gLcd.ddram[(gLcd.addr & 0x40) ? 1 : 0][(gLcd.addr & 0x3F) % 40] = (char)b;
+	gLcd.addr = (uint8_t)((gLcd.addr & 0x40) | (((gLcd.addr & 0x3F) + 1) % 40));
+}
+
+//falling edge of E: the HD44780 takes the nibble on PD4..PD7
+static void LcdEdge(void)
+{
+	GPIO_TypeDef *d = &gPort[PORT_LCD];
+	uint8_t e = d->ODR & LCD_E;
+	uint8_t nib = d->ODR >> 4;
+
+	if (gLcd.e && !e)
+	{
+		if (gLcd.mode8)
+		{
+			if ((nib << 4) == 0x20)
+			{
+				gLcd.mode8 = 0;
+			}
+		}
+		else if (!gLcd.high)
+		{
+			gLcd.nibble = nib;
+			gLcd.high = 1;
+		}
+		else
+		{
+			gLcd.high = 0;
+			LcdByte(d->ODR & LCD_RS, (uint8_t)((gLcd.nibble << 4) | nib));
+		}
+	}
+	gLcd.e = e;
+}
+
+//16 characters of a line as shown on page 0 or 1, glyphs as D, O and u
+void HwLcdLine(uint8_t line, uint8_t page, char *buf)
+{
+	uint8_t i;
+	char c;
+
+	for (i = 0; i < 16; i++)
+	{
+		c = gLcd.ddram[line][(i + (page ? LCD_PAGE : 0)) % 40];
+		buf[i] = (c == 8) ? 'D' : (c == 9) ? 'O' : (c == 10) ? 'u' : c;
+	}
+	buf[16] = 0;
+}
+
+void GPIO_DeInit(GPIO_TypeDef *port)
+{
+	port->ODR = 0;
+	port->DDR = 0;
+	port->CR1 = 0;
+	port->CR2 = 0;
+}
+
+void GPIO_Init(GPIO_TypeDef *port, GPIO_Pin_TypeDef pins, GPIO_Mode_TypeDef mode)
+{
+	if (mode & 0x80)
+	{
+		port->DDR |= pins;
+		port->CR1 |= pins;
+		if (mode & 0x10)
+		{
+			port->ODR |= pins;
+		}
+		else
+		{
+			port->ODR &= (uint8_t)~pins;
+		}
+	}
+	else
+	{
+		port->DDR &= (uint8_t)~pins;
+	}
+}
+
+void GPIO_Write(GPIO_TypeDef *port, uint8_t value)
+{
+	port->ODR = value;
+}
+
+uint8_t GPIO_ReadOutputData(GPIO_TypeDef *port)
+{
+	return port->ODR;
+}
+
+void GPIO_WriteHigh(GPIO_TypeDef *port, GPIO_Pin_TypeDef pins)
+{
+	port->ODR |= pins;
+	if (port == &gPort[PORT_LCD])
+	{
+		LcdEdge();
+	}
+}
+
+void GPIO_WriteLow(GPIO_TypeDef *port, GPIO_Pin_TypeDef pins)
+{
+	port->ODR &= (uint8_t)~pins;
+	if (port == &gPort[PORT_LCD])
+	{
+		LcdEdge();
+	}
+}
+
+//--- ADC1
+
+static void Convert(void)
+{
+	uint8_t ch;
+
+	if (gConv.scan)
+	{
+		for (ch = 0; ch <= gConv.ch; ch++)
+		{
+			gConv.buf[ch] = Sample(ch);
+			HwNs += 14000000000ULL * gConv.div / F_CPU;
+		}
+		gConv.value = gConv.buf[gConv.ch];
+	}
+	else
+	{
+		gConv.value = Sample(gConv.ch);
+		HwNs += 14000000000ULL * gConv.div / F_CPU;
+	}
+	gADC.CSR |= ADC1_CSR_EOC;
+	if ((gConv.awd == gConv.ch) && ((gConv.value > gConv.hi) || (gConv.value < gConv.lo)))
+	{
+		gADC.CSR |= ADC1_CSR_AWD;
+	}
+}
+
+//continuous mode: one conversion per access, the CPU polls AWD meanwhile
+ADC1_TypeDef *HostADC(void)
+{
+	if ((gADC.CR1 & ADC1_CR1_CONT) && (gADC.CR1 & ADC1_CR1_ADON))
+	{
+		Convert();
+	}
+
+	return &gADC;
+}
+
+void ADC1_DeInit(void)
+{
+	memset(&gADC, 0, sizeof(gADC));
+	gConv.scan = 0;
+	gConv.trig = 0;
+	gConv.awd = 0xFF;
+}
+
+void ADC1_Init(ADC1_ConvMode_TypeDef mode, ADC1_Channel_TypeDef channel, ADC1_PresSel_TypeDef pres,
+	ADC1_ExtTrig_TypeDef trig, FunctionalState trigstate, ADC1_Align_TypeDef align,
+	ADC1_SchmittTrigg_TypeDef schmitt, FunctionalState schmittstate)
+{
+	static const uint8_t div[8] = {2, 3, 4, 6, 8, 10, 12, 18};
+
+	(void)trig;
+	(void)align;
+	(void)schmitt;
+	(void)schmittstate;
+	gConv.ch = channel;
+	gConv.div = div[(pres >> 4) & 7];
+	gConv.trig = (trigstate == ENABLE);
+	gADC.CR1 = (uint8_t)(ADC1_CR1_ADON | ((mode == ADC1_CONVERSIONMODE_CONTINUOUS) ? ADC1_CR1_CONT : 0));
+}
+
+void ADC1_ScanModeCmd(FunctionalState state)
+{
+	gConv.scan = (state == ENABLE);
+}
+
+void ADC1_ExternalTriggerConfig(ADC1_ExtTrig_TypeDef trig, FunctionalState state)
+{
+	(void)trig;
+	gConv.trig = (state == ENABLE);
+}
+
+void ADC1_StartConversion(void)
+{
+	Convert();
+}
+
+/*
+EOC of a conversion started by TIM1: the timer period passes first.
+In one pulse mode the timer stops after its update.
+*/
+FlagStatus ADC1_GetFlagStatus(ADC1_Flag_TypeDef flag)
+{
+	uint32_t arr;
+
+	HwNs += POLL_NS / 4;
+	if ((flag == ADC1_FLAG_EOC) && !(gADC.CSR & ADC1_CSR_EOC) && gConv.trig && (HostTIM1.CR1 & TIM1_CR1_CEN))
+	{
+		arr = ((uint32_t)HostTIM1.ARRH << 8) | HostTIM1.ARRL;
+		HwNs += (arr + 1) * 1000000000ULL / F_CPU;
+		if (HostTIM1.CR1 & TIM1_CR1_OPM)
+		{
+			HostTIM1.CR1 &= (uint8_t)~TIM1_CR1_CEN;
+		}
+		Convert();
+	}
+
+	return (gADC.CSR & (uint8_t)flag) ? SET : RESET;
+}
+
+void ADC1_ClearFlag(ADC1_Flag_TypeDef flag)
+{
+	gADC.CSR &= (uint8_t)~flag;
+}
+
+uint16_t ADC1_GetConversionValue(void)
+{
+	return gConv.value;
+}
+
+uint16_t ADC1_GetBufferValue(uint8_t buffer)
+{
+	return gConv.buf[buffer];
+}
+
+void ADC1_SetHighThreshold(uint16_t threshold)
+{
+	gConv.hi = threshold;
+}
+
+void ADC1_SetLowThreshold(uint16_t threshold)
+{
+	gConv.lo = threshold;
+}
+
+void ADC1_AWDChannelConfig(ADC1_Channel_TypeDef channel, FunctionalState state)
+{
+	gConv.awd = (state == ENABLE) ? channel : 0xFF;
+}
+
+//--- UART2: what the firmware wrote to DR is sent at the next access
+
+UART2_TypeDef *HostUART(void)
+{
+	if (gUART.DR)
+	{
+		if (HwUart)
+		{
+			fputc(gUART.DR, HwUart);
+		}
+		gUART.DR = 0;
+	}
+	gUART.SR = UART2_SR_TXE | UART2_SR_TC;
+
+	return &gUART;
+}
@@ -0,0 +1,63 @@
+#ifndef __HW_H__
+#define __HW_H__
+
+#include <stdio.h>
+
+/*
+Simulated tester hardware for the host build of the firmware.
+Every socket holds a part made of up to HW_ELEMENTS elements between TP1..TP3.
+Each ADC conversion solves the DC network of the selected socket: the
+probe pins driven over GPIOB (firmly), R_L or R_H (GPIOC), the part and a
+small leakage of every pin. The model is static: there are no capacitances,
+a node is at its final voltage at once, except for a charged capacitor
+(HW_Q). It is a voltage source that follows its current between two
+conversions or port accesses, over R_L/R_H of the selected socket or over
+the discharge switches. Node voltages below ground are clamped, as by the
+protection diodes of the pins. The time only advances with the
+waits, the conversions and the polls of the firmware.
+The analog mux of socket.c is modelled with its address and discharge
+lines; switching with R_L/R_H connected or converting on a socket that is
+still discharged counts as an error.
+*/
+#define HW_SOCKETS 4
+#define HW_ELEMENTS 3
+
+#define HW_NONE 0
+#define HW_R 1				//a-b, v1 = ohm
+#define HW_D 2				//anode a, cathode b, v1 = Is in A, v2 = ideality n
+#define HW_NPN 3			//base a, collector b, emitter c, v1 = Is in A, v2 = beta
+#define HW_PNP 4
+#define HW_Q 5				//plus a, minus b, v1 = C in F, v2 = voltage, changes as it is (dis)charged
+#define HW_NMOS 6			//gate a, drain b, source c, v1 = threshold in V, v2 = k in A/V^2; gate capacitance as HW_Q
+#define HW_PMOS 7
+
+#define HW_VCC 5.0
+#define HW_R_PORT 20.0		//output resistance of a GPIO driver, in series with R_L/R_H on GPIOC
+#define HW_R_DIS 10.0		//discharge switch of a socket
+#define HW_R_ESR 1.0		//series resistance of a capacitor (HW_Q)
+#define HW_G_PIN 1e-9		//leakage of every pin to ground
+#define HW_NOISE 0.5		//rms noise of a conversion in LSB, dithers the quantization
+
+typedef struct
+{
+	uint8_t Kind;			//HW_...
+	uint8_t a, b, c;		//TP1..TP3 = 0..2
+	double v1, v2;
+} HwElement;
+
+typedef struct
+{
+	HwElement e[HW_ELEMENTS];
+} HwPart;
+
+extern HwPart HwSocket[HW_SOCKETS];
+extern uint64_t HwNs;			//simulated time since HwReset
+extern unsigned int HwErrors;	//violations of the mux rules
+extern uint64_t HwHeld[HW_SOCKETS];	//ns the socket was discharged before its last selection
+extern FILE *HwUart;			//receives what the firmware sends on UART2, may be 0
+
+void HwReset(void);
+
+void HwLcdLine(uint8_t line, uint8_t page, char *buf);
+
+#endif
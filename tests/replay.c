@@ -0,0 +1,372 @@
+/*
+Replay of a flight recorder dump (trace.h) through the identification code
+of main.c. The readings of adc.h are taken from the dump instead of the ADC,
+so ScanSockets and ShowResult run the decision path of the recorded test again.
+Every reading is checked against its record: the channel and the pin state
+of GPIOB/GPIOC, and TraceMark the step of TestPart. The time of the host
+build is moved on to the time of each record, so the loops on Ticks() take
+the same turns. hw.c supplies the registers, the time and the LCD, its ADC
+is not used.
+Prints the display of every socket as sim.c does.
+usage: replay dump
+*/
+#include <stdio.h>
+#include <string.h>
+#include "stm8s.h"
+#include "HD44780.h"
+#include "adc.h"
+#include "tester.h"
+#include "socket.h"
+#include "watchdog.h"
+#include "text.h"
+#include "trace.h"
+#include "hw.h"
+
+#define NS_PER_TICK ((1000000000ULL << TICK_SHIFT) / F_CPU)
+#define REPLAY_MAX 8192		//records of one dump
+#define REPLAY_SHOWN 5		//mismatches printed, the rest is only counted
+
+void ScanSockets(void);
+uint8_t ShowResult(const TestContext *tc);
+
+extern TestContext ctx[SOCKETS];
+extern const char TestRunning[];
+
+typedef struct
+{
+	uint8_t ch;				//TP1..TP3 or TRACE_MARK
+	uint8_t id;				//of a mark
+	uint16_t value;
+	uint16_t ticks;
+	uint8_t port[3];		//GPIOB DDR | ODR << 3, GPIOC DDR, GPIOC ODR
+} Record;
+
+static Record gRec[REPLAY_MAX];
+static unsigned int gLen, gPos, gErrors;
+static uint8_t gFull;
+
+uint8_t ADCTimeout;
+
+//reads the hex lines of TraceDump and decodes them as tools/tracereplay.py does
+static int Load(const char *name)
+{
+	static uint8_t data[65536];
+	char line[128], *p;
+	unsigned int len = 0, end = 0, full = 0, b, i;
+	uint16_t time = 0, last[3] = {0, 0, 0};
+	uint8_t port[3] = {0, 0, 0}, h;
+	Record *r;
+	FILE *f;
+
+	f = fopen(name, "r");
+	if (!f)
+	{
+		perror(name);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		if (line[0] == ':')
+		{
+			for (p = line + 1; sscanf(p, "%2x", &b) == 1; p += 2)
+			{
+				data[len++] = (uint8_t)b;
+			}
+		}
+		else if (!strncmp(line, "END", 3))
+		{
+			sscanf(line + 3, "%x %x", &end, &full);
+		}
+	}
+	fclose(f);
+	if (!len || (end != len))
+	{
+		printf("FAIL: %s: %u bytes, END says %u\n", name, len, end);
+		return 0;
+	}
+	gFull = (uint8_t)full;
+
+	for (i = 0; (i < len) && (gLen < REPLAY_MAX); gLen++)
+	{
+		r = &gRec[gLen];
+		h = data[i++];
+		r->ch = h & 3;
+		time += h >> 4;
+		if (r->ch == TRACE_MARK)
+		{
+			r->id = data[i];
+			time = (uint16_t)((data[i + 1] << 8) | data[i + 2]);
+			i += 3;
+		}
+		else
+		{
+			if (h & 4)
+			{
+				memcpy(port, &data[i], 3);
+				i += 3;
+			}
+			if (h & 8)
+			{
+				r->value = (uint16_t)(last[r->ch] + (int8_t)data[i++]);
+			}
+			else
+			{
+				r->value = (uint16_t)((data[i] << 8) | data[i + 1]);
+				i += 2;
+			}
+			last[r->ch] = r->value;
+			memcpy(r->port, port, 3);
+		}
+		r->ticks = time;
+	}
+
+	return 1;
+}
+
+static void Mismatch(const char *what, unsigned int want, unsigned int got)
+{
+	if (gErrors++ < REPLAY_SHOWN)
+	{
+		printf("FAIL: record %u: %s %u, recorded %u\n", gPos, what, got, want);
+	}
+}
+
+//next record, the simulated time is moved on to it
+static const Record *Take(void)
+{
+	static const Record none = {0xFF};
+	const Record *r;
+	int16_t d;
+
+	if (gPos >= gLen)
+	{
+		Mismatch("reading after the end of the trace, records", gLen, gPos + 1);
+		return &none;
+	}
+	r = &gRec[gPos++];
+	d = (int16_t)(r->ticks - (uint16_t)(HwNs / NS_PER_TICK));
+	if (d > 0)
+	{
+		HwNs += d * NS_PER_TICK - HwNs % NS_PER_TICK;	//start of the tick, the recorded reading was early in it
+	}
+
+	return r;
+}
+
+//value of the next reading of tp, checked against the pin state now
+static uint16_t Next(uint8_t tp)
+{
+	const Record *r = Take();
+	uint8_t port[3];
+
+	port[0] = (uint8_t)((GPIOB->DDR & 7) | ((GPIOB->ODR & 7) << 3));
+	port[1] = GPIOC->DDR;
+	port[2] = GPIOC->ODR;
+	if (r->ch != tp)
+	{
+		Mismatch("channel", r->ch, tp);
+	}
+	else if (memcmp(port, r->port, 3))
+	{
+		Mismatch("pin state", (r->port[0] << 16) | (r->port[1] << 8) | r->port[2],
+			(port[0] << 16) | (port[1] << 8) | port[2]);
+	}
+
+	return r->value;
+}
+
+//--- trace.h
+
+void TraceStart(void)
+{
+}
+
+void TraceMark(uint8_t id)
+{
+	const Record *r = Take();
+
+	if ((r->ch != TRACE_MARK) || (r->id != id))
+	{
+		Mismatch("step", (r->ch == TRACE_MARK) ? r->id : 0xFF, id);
+	}
+}
+
+void TraceADC(uint8_t ch, uint16_t value)
+{
+	(void)ch;
+	(void)value;
+}
+
+void TraceDump(void)
+{
+}
+
+//--- adc.h, the records of each reading as listed in trace.h
+
+uint16_t ReadADC(uint8_t tp)
+{
+	return Next(tp);
+}
+
+uint16_t ReadADCStat(uint8_t tp, ADCStat *stat)
+{
+	uint16_t value = Next(tp);
+
+	if (stat)
+	{
+		stat->Mean = value;
+		stat->Spread = 0;	//not recorded, nothing in main.c decides on it
+		stat->Count = ADC_SAMPLES;
+	}
+
+	return value;
+}
+
+uint16_t ReadADCCoarse(uint8_t tp)
+{
+	return Next(tp);
+}
+
+uint8_t ReadADCAbove(uint8_t tp, uint16_t Level, uint8_t Margin, ADCStat *stat)
+{
+	(void)Margin;
+
+	return (ReadADCStat(tp, stat) > Level);
+}
+
+uint16_t ReadADCLong(uint8_t tp)
+{
+	return Next(tp);
+}
+
+uint16_t ReadADCSync(uint8_t tp)
+{
+	return Next(tp);
+}
+
+uint16_t WaitADC(uint8_t tp, uint16_t Level, uint8_t Rising, uint16_t MaxCount)
+{
+	(void)Level;
+	(void)Rising;
+	(void)MaxCount;
+
+	return Next(tp);
+}
+
+uint16_t RiseTimeADC(uint8_t tp, uint16_t Level, uint16_t MaxCount)
+{
+	(void)Level;
+	(void)MaxCount;
+
+	Next(tp);	//last conversion
+
+	return Next(tp);
+}
+
+uint16_t WatchADC(uint8_t tp, uint16_t Level, uint8_t Rising, uint16_t MaxMs)
+{
+	(void)Level;
+	(void)Rising;
+	(void)MaxMs;
+
+	return Next(tp);
+}
+
+void ReadADCScan(uint16_t *adc)
+{
+	adc[TP1] = Next(TP1);
+	adc[TP2] = Next(TP2);
+	adc[TP3] = Next(TP3);
+}
+
+void ReadADCPair(uint8_t tpA, uint8_t tpB, uint16_t *a, uint16_t *b)
+{
+	*a = Next(tpA);
+	*b = Next(tpB);
+}
+
+void ReadADCPairFine(uint8_t tpA, uint8_t tpB, uint16_t *a, uint16_t *b)
+{
+	ReadADCPair(tpA, tpB, a, b);
+}
+
+uint16_t ReadADCDiff(uint8_t tpHigh, uint8_t tpLow, uint16_t *low)
+{
+	uint16_t h, l;
+
+	ReadADCPair(tpHigh, tpLow, &h, &l);
+	if (low)
+	{
+		*low = l;
+	}
+
+	return (h > l) ? (h - l) : 0;
+}
+
+uint16_t ReadADCDiffSync(uint8_t tpHigh, uint8_t tpLow, uint16_t *low)
+{
+	return ReadADCDiff(tpHigh, tpLow, low);
+}
+
+void SweepADC(uint8_t tp, uint8_t Fwd, uint8_t Rev, uint16_t *buf)
+{
+	uint8_t n;
+
+	(void)Rev;
+	GPIOC->ODR = Fwd;	//as after the capture
+	for (n = 0; n < SWEEP_POINTS; n++)
+	{
+		buf[n] = Next(tp);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t s, page, line, pages;
+	char buf[17];
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "usage: replay <dump>\n");
+		return 2;
+	}
+	HwReset();
+	if (!Load(argv[1]))
+	{
+		return 1;
+	}
+
+	InitWatchdog();
+	StartLcd(GPIOD, GPIO_PIN_2, GPIO_PIN_3, GPIO_PIN_HNIB, TestRunning);
+	InitSockets();
+	ScanSockets();
+	FinishLcd();
+	LoadGlyphs();
+
+	for (s = 0; s < SOCKETS; s++)
+	{
+		pages = ShowResult(&ctx[s]);
+		printf("socket %d\n", s);
+		for (page = 0; page <= pages; page++)
+		{
+			for (line = 0; line < 2; line++)
+			{
+				HwLcdLine(line, page, buf);
+				printf("  |%s|\n", buf);
+			}
+		}
+	}
+
+	if (gPos < gLen)
+	{
+		Mismatch("records left over", gLen - gPos, 0);
+	}
+	if (gFull)
+	{
+		printf("FAIL: the trace buffer was full, TRACE_SIZE is too small\n");
+		gErrors++;
+	}
+	printf("replayed %u records, %u mismatches\n", gPos, gErrors);
+
+	return (gErrors != 0);
+}
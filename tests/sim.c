@@ -0,0 +1,242 @@
+/*
+Host run of the firmware on the simulated tester (hw.c): the scan of main()
+over all sockets of the mux, each with a known part. Checks that every
+socket reports its own part, that the mux rules of socket.c hold (hw.c) and
+that ScanSockets takes less time than the tests of the sockets one after the
+other (SelectSocket and TestPart each): socket 0 holds a charged capacitor,
+the scan leaves it on its discharge line while the others are tested.
+After the scan the parts of gExtra are tested one by one on socket 0, for the
+results of the pre-check (PreCheck) that need no mux and for the MOSFETs:
+their gate threshold must lie between the model's Vt and 20 % above it (the
+drain current at the switching point and the latency of WaitADC add to it).
+Prints the display of every socket and the timing.
+-DLCD_BLOCKING starts the display as before StartLcd (blocking InitLcd and
+banner ahead of the first test), for comparing the time to the first result.
+Built with -DTRACE=1 the flight recorder runs as in main() and the dump goes
+to the file given as argument, for tests/replay.c.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "stm8s.h"
+#include "HD44780.h"
+#include "adc.h"
+#include "tester.h"
+#include "socket.h"
+#include "watchdog.h"
+#include "text.h"
+#include "trace.h"
+#include "hw.h"
+
+void TestPart(TestContext *tc);
+void ScanSockets(void);
+uint8_t ShowResult(const TestContext *tc);
+
+extern TestContext ctx[SOCKETS];
+extern const char TestRunning[];
+
+#define FOUND_ANY 0xFF	//a capacitor after its discharge: found is whatever its charging looks like
+
+typedef struct
+{
+	HwPart part;
+	uint8_t found;		//PART_... or FOUND_ANY
+	uint8_t contact;	//CONTACT_... of PART_NONE
+	uint8_t charged;	//CHARGE_...
+	const char *name;
+} Case;
+
+static const Case gCase[HW_SOCKETS] =
+{
+	{{{{HW_Q, TP1, TP3, 0, 470e-6, 4.0}}}, FOUND_ANY, CONTACT_NONE, CHARGE_FOUND, "470u at 4 V TP1-TP3"},
+	{{{{HW_R, TP1, TP3, 0, 4700, 0}}}, PART_RESISTOR, CONTACT_NONE, CHARGE_NONE, "4k7 TP1-TP3"},
+	{{{{HW_D, TP2, TP1, 0, 2.5e-9, 1.9}}}, PART_DIODE, CONTACT_NONE, CHARGE_NONE, "1N4148 A=TP2 K=TP1"},
+	{{{{HW_NPN, TP2, TP1, TP3, 1e-14, 300}}}, PART_TRANSISTOR, CONTACT_NONE, CHARGE_NONE, "NPN B=TP2 C=TP1 E=TP3"}
+};
+
+static const Case gExtra[] =
+{
+	{{{{HW_NONE}}}, PART_NONE, CONTACT_OPEN, CHARGE_NONE, "empty"},
+	{{{{HW_R, TP2, TP3, 0, 0.1, 0}}}, PART_NONE, CONTACT_SHORT, CHARGE_NONE, "short TP2-TP3"},
+	{{{{HW_NMOS, TP1, TP2, TP3, 2.0, 0.5}, {HW_Q, TP1, TP3, 0, 1e-9, 0}, {HW_D, TP3, TP2, 0, 1e-12, 1.5}}},
+		PART_FET, CONTACT_NONE, CHARGE_NONE, "N-MOSFET Vt=2.0 V G=TP1 D=TP2 S=TP3"},
+	{{{{HW_PMOS, TP3, TP1, TP2, 1.8, 0.5}, {HW_Q, TP2, TP3, 0, 1e-9, 0}, {HW_D, TP1, TP2, 0, 1e-12, 1.5}}},
+		PART_FET, CONTACT_NONE, CHARGE_NONE, "P-MOSFET Vt=1.8 V G=TP3 D=TP1 S=TP2"}
+};
+
+//the pins of the part as found, 0 if they do not match the case
+static uint8_t PinsMatch(const Case *c, const TestContext *tc)
+{
+	const HwElement *e = &c->part.e[0];
+
+	if (tc->Charged != c->charged)
+	{
+		return 0;
+	}
+	if (c->found == FOUND_ANY)
+	{
+		return 1;
+	}
+	if (tc->Contact != c->contact)
+	{
+		return 0;
+	}
+	switch (tc->PartFound)
+	{
+	case PART_RESISTOR:
+		return ((tc->ra == e->a) && (tc->rb == e->b)) || ((tc->ra == e->b) && (tc->rb == e->a));
+	case PART_DIODE:
+		return (tc->NumOfDiodes == 1) && (tc->diodes[0].Anode == e->a) && (tc->diodes[0].Cathode == e->b);
+	case PART_TRANSISTOR:
+		return (tc->PartMode == PART_MODE_NPN) && (tc->b == e->a) && (tc->c == e->b) && (tc->e == e->c);
+	case PART_FET:
+		return (tc->PartMode == ((e->Kind == HW_NMOS) ? PART_MODE_N_E_MOS : PART_MODE_P_E_MOS))
+			&& (tc->b == e->a) && (tc->c == e->b) && (tc->e == e->c)
+			&& (tc->gthvoltage >= e->v1 * 1000) && (tc->gthvoltage <= e->v1 * 1200);
+	case PART_NONE:
+		return (tc->Contact == CONTACT_OPEN) || (tc->ContactPins == ((1 << e->a) | (1 << e->b)));
+	}
+
+	return 0;
+}
+
+/*
+Prints the display of tc, pages as returned by ShowResult, and shows it again as
+the loop of main() does. 1 if it does not report the part of c or changes.
+*/
+static uint8_t Show(const Case *c, const TestContext *tc, uint8_t pages)
+{
+	uint8_t page, line, fail = 0;
+	char buf[2][2][17], again[17];
+
+	for (page = 0; page <= pages; page++)
+	{
+		for (line = 0; line < 2; line++)
+		{
+			HwLcdLine(line, page, buf[page][line]);
+			printf("  |%s|\n", buf[page][line]);
+		}
+	}
+	if (((c->found != FOUND_ANY) && (tc->PartFound != c->found)) || !PinsMatch(c, tc))
+	{
+		printf("  FAIL: expected %s\n", c->name);
+		fail = 1;
+	}
+	if (ShowResult(tc) != pages)
+	{
+		printf("  FAIL: the second display has other pages\n");
+		return 1;
+	}
+	for (page = 0; page <= pages; page++)
+	{
+		for (line = 0; line < 2; line++)
+		{
+			HwLcdLine(line, page, again);
+			if (strcmp(again, buf[page][line]))
+			{
+				printf("  FAIL: shown again as |%s|\n", again);
+				fail = 1;
+			}
+		}
+	}
+
+	return fail;
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t s, i, pages, fail = 0;
+	uint64_t start, t[SOCKETS], sum = 0, scan, first = 0;
+
+	HwReset();
+	if (argc > 1)
+	{
+		HwUart = fopen(argv[1], "w");
+		if (!HwUart)
+		{
+			perror(argv[1]);
+			return 1;
+		}
+	}
+	for (s = 0; s < SOCKETS; s++)
+	{
+		HwSocket[s] = gCase[s % HW_SOCKETS].part;
+	}
+
+	InitWatchdog();
+#ifdef LCD_BLOCKING
+	InitLcd(GPIOD, GPIO_PIN_2, GPIO_PIN_3, GPIO_PIN_HNIB);
+	ClearLcd(0);
+	Outline(0, TestRunning);
+#else
+	StartLcd(GPIOD, GPIO_PIN_2, GPIO_PIN_3, GPIO_PIN_HNIB, TestRunning);
+#endif
+	InitSockets();
+	start = HwNs;
+	TraceStart();
+	ScanSockets();
+	scan = HwNs - start;
+	FinishLcd();
+	LoadGlyphs();
+
+	for (s = 0; s < SOCKETS; s++)
+	{
+		pages = ShowResult(&ctx[s]);
+		if (!s)
+		{
+			first = HwNs;
+		}
+		printf("socket %d: %s, discharged %llu ms before\n", s, gCase[s % HW_SOCKETS].name,
+			(unsigned long long)(HwHeld[s] / 1000000));
+		fail |= Show(&gCase[s % HW_SOCKETS], &ctx[s], pages);
+	}
+	TraceDump();	//after the timing, the dump takes seconds at TRACE_BAUD
+
+	//the same parts, charged again, tested one after the other
+	ReleaseSockets();	//the time until now still belongs to the parts of the scan (hw.c)
+	for (s = 0; s < SOCKETS; s++)
+	{
+		HwSocket[s] = gCase[s % HW_SOCKETS].part;
+	}
+	InitSockets();
+	for (s = 0; s < SOCKETS; s++)
+	{
+		t[s] = HwNs;
+		SelectSocket(s);
+		TestPart(&ctx[s]);
+		t[s] = HwNs - t[s];
+		sum += t[s];
+		printf("socket %d alone: %llu ms\n", s, (unsigned long long)(t[s] / 1000000));
+	}
+	ReleaseSockets();
+
+	printf("scan of %d sockets: %llu ms, sum of the tests %llu ms\n", SOCKETS,
+		(unsigned long long)(scan / 1000000), (unsigned long long)(sum / 1000000));
+	printf("first result after %llu ms\n", (unsigned long long)(first / 1000000));
+	if (scan >= sum)
+	{
+		printf("FAIL: the scan takes as long as its tests one after the other\n");
+		fail = 1;
+	}
+	if (HwErrors)
+	{
+		printf("FAIL: %u violations of the mux rules\n", HwErrors);
+		fail = 1;
+	}
+
+	for (i = 0; i < sizeof(gExtra) / sizeof(gExtra[0]); i++)
+	{
+		HwSocket[0] = gExtra[i].part;
+		SelectSocket(0);
+		TestPart(&ctx[0]);
+		ReleaseSockets();
+		pages = ShowResult(&ctx[0]);
+		printf("socket 0: %s\n", gExtra[i].name);
+		fail |= Show(&gExtra[i], &ctx[0], pages);
+	}
+	if (HwUart)
+	{
+		fclose(HwUart);
+	}
+
+	return fail;
+}
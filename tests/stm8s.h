@@ -0,0 +1,131 @@
+/*
+Host stand-in for the ST peripheral library header (tests/ only).
+The registers are plain structs in RAM. GPIO, ADC1, TIM2 and UART2 are
+reached through functions of hw.c, so every access of the firmware can
+advance the simulated time or check the state of the simulated hardware.
+*/
+#ifndef __STM8S_H
+#define __STM8S_H
+
+#include <stdint.h>
+
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus, BitStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+typedef enum {ERROR = 0, SUCCESS = !ERROR} ErrorStatus;
+
+typedef struct
+{
+	volatile uint8_t ODR, IDR, DDR, CR1, CR2;
+} GPIO_TypeDef;
+
+typedef enum
+{
+	GPIO_PIN_0 = 0x01, GPIO_PIN_1 = 0x02, GPIO_PIN_2 = 0x04, GPIO_PIN_3 = 0x08,
+	GPIO_PIN_4 = 0x10, GPIO_PIN_5 = 0x20, GPIO_PIN_6 = 0x40, GPIO_PIN_7 = 0x80,
+	GPIO_PIN_LNIB = 0x0F, GPIO_PIN_HNIB = 0xF0, GPIO_PIN_ALL = 0xFF
+} GPIO_Pin_TypeDef;
+
+typedef enum
+{
+	GPIO_MODE_IN_FL_NO_IT = 0x00,
+	GPIO_MODE_OUT_PP_LOW_FAST = 0xE0,
+	GPIO_MODE_OUT_PP_HIGH_FAST = 0xF0
+} GPIO_Mode_TypeDef;
+
+typedef struct
+{
+	volatile uint8_t DB[20];
+	uint8_t RES[12];
+	volatile uint8_t CSR, CR1, CR2, CR3, DRH, DRL, TDRH, TDRL;
+	volatile uint8_t HTRH, HTRL, LTRH, LTRL, AWSRH, AWSRL, AWCRH, AWCRL;
+} ADC1_TypeDef;
+
+#define ADC1_CSR_EOC 0x80
+#define ADC1_CSR_AWD 0x40
+#define ADC1_CR1_CONT 0x02
+#define ADC1_CR1_ADON 0x01
+
+typedef struct
+{
+	volatile uint8_t CR1, CR2, SMCR, ETR, IER, SR1, SR2, EGR, CCMR1, CCMR2, CCMR3, CCMR4;
+	volatile uint8_t CCER1, CCER2, CNTRH, CNTRL, PSCRH, PSCRL, ARRH, ARRL;
+} TIM1_TypeDef;
+
+#define TIM1_CR1_CEN 0x01
+#define TIM1_CR1_OPM 0x08
+#define TIM1_EGR_UG 0x01
+
+typedef struct
+{
+	volatile uint8_t CR1, IER, SR1, SR2, EGR, CCMR1, CCMR2, CCMR3, CCER1, CCER2;
+	volatile uint8_t CNTRH, CNTRL, PSCR, ARRH, ARRL;
+} TIM2_TypeDef;
+
+#define TIM2_CR1_CEN 0x01
+#define TIM2_EGR_UG 0x01
+
+typedef struct
+{
+	volatile uint8_t SR, DR, BRR1, BRR2, CR1, CR2, CR3, CR4, CR5, CR6, GTR, PSCR;
+} UART2_TypeDef;
+
+#define UART2_SR_TXE 0x80
+#define UART2_SR_TC 0x40
+#define UART2_CR2_TEN 0x08
+
+typedef struct
+{
+	volatile uint8_t KR, PR, RLR;
+} IWDG_TypeDef;
+
+typedef struct
+{
+	volatile uint8_t SR;
+} RST_TypeDef;
+
+#define RST_SR_IWDGF 0x02
+
+typedef struct
+{
+	volatile uint8_t CR1, CR2, NCR2, FPR, NFPR, IAPSR, RES1, RES2, PUKR, RES3, DUKR;
+} FLASH_TypeDef;
+
+#define FLASH_IAPSR_DUL 0x08
+
+GPIO_TypeDef *HostPort(uint8_t n);
+ADC1_TypeDef *HostADC(void);
+TIM2_TypeDef *HostTIM2(void);
+UART2_TypeDef *HostUART(void);
+
+extern TIM1_TypeDef HostTIM1;
+extern IWDG_TypeDef HostIWDG;
+extern RST_TypeDef HostRST;
+extern FLASH_TypeDef HostFLASH;
+
+#define GPIOA HostPort(0)
+#define GPIOB HostPort(1)
+#define GPIOC HostPort(2)
+#define GPIOD HostPort(3)
+#define GPIOE HostPort(4)
+#define GPIOF HostPort(5)
+#define GPIOG HostPort(6)
+#define ADC1 HostADC()
+#define TIM2 HostTIM2()
+#define UART2 HostUART()
+#define TIM1 (&HostTIM1)
+#define IWDG (&HostIWDG)
+#define RST (&HostRST)
+#define FLASH (&HostFLASH)
+
+void GPIO_DeInit(GPIO_TypeDef *port);
+void GPIO_Init(GPIO_TypeDef *port, GPIO_Pin_TypeDef pins, GPIO_Mode_TypeDef mode);
+void GPIO_Write(GPIO_TypeDef *port, uint8_t value);
+uint8_t GPIO_ReadOutputData(GPIO_TypeDef *port);
+void GPIO_WriteHigh(GPIO_TypeDef *port, GPIO_Pin_TypeDef pins);
+void GPIO_WriteLow(GPIO_TypeDef *port, GPIO_Pin_TypeDef pins);
+
+#define enableInterrupts()
+#define disableInterrupts()
+#define nop()
+
+#endif
@@ -0,0 +1,44 @@
+/*
+Host stand-in for the ADC1 part of the ST peripheral library (tests/ only),
+the functions are simulated in hw.c.
+*/
+#ifndef __STM8S_ADC1_H
+#define __STM8S_ADC1_H
+
+#include "stm8s.h"
+
+typedef enum
+{
+	ADC1_CONVERSIONMODE_SINGLE = 0,
+	ADC1_CONVERSIONMODE_CONTINUOUS = 1
+} ADC1_ConvMode_TypeDef;
+
+typedef enum
+{
+	ADC1_PRESSEL_FCPU_D2 = 0x00, ADC1_PRESSEL_FCPU_D3 = 0x10, ADC1_PRESSEL_FCPU_D4 = 0x20,
+	ADC1_PRESSEL_FCPU_D6 = 0x30, ADC1_PRESSEL_FCPU_D8 = 0x40, ADC1_PRESSEL_FCPU_D10 = 0x50,
+	ADC1_PRESSEL_FCPU_D12 = 0x60, ADC1_PRESSEL_FCPU_D18 = 0x70
+} ADC1_PresSel_TypeDef;
+
+typedef enum {ADC1_EXTTRIG_TIM = 0x00, ADC1_EXTTRIG_GPIO = 0x10} ADC1_ExtTrig_TypeDef;
+typedef enum {ADC1_ALIGN_LEFT = 0x00, ADC1_ALIGN_RIGHT = 0x08} ADC1_Align_TypeDef;
+typedef enum {ADC1_FLAG_OVR = 0x41, ADC1_FLAG_AWD = 0x40, ADC1_FLAG_EOC = 0x80} ADC1_Flag_TypeDef;
+typedef enum {ADC1_SCHMITTTRIG_CHANNEL0 = 0x00, ADC1_SCHMITTTRIG_ALL = 0xFF} ADC1_SchmittTrigg_TypeDef;
+typedef enum {ADC1_CHANNEL_0 = 0, ADC1_CHANNEL_1 = 1, ADC1_CHANNEL_2 = 2, ADC1_CHANNEL_3 = 3} ADC1_Channel_TypeDef;
+
+void ADC1_DeInit(void);
+void ADC1_Init(ADC1_ConvMode_TypeDef mode, ADC1_Channel_TypeDef channel, ADC1_PresSel_TypeDef pres,
+	ADC1_ExtTrig_TypeDef trig, FunctionalState trigstate, ADC1_Align_TypeDef align,
+	ADC1_SchmittTrigg_TypeDef schmitt, FunctionalState schmittstate);
+void ADC1_ScanModeCmd(FunctionalState state);
+void ADC1_ExternalTriggerConfig(ADC1_ExtTrig_TypeDef trig, FunctionalState state);
+void ADC1_StartConversion(void);
+FlagStatus ADC1_GetFlagStatus(ADC1_Flag_TypeDef flag);
+void ADC1_ClearFlag(ADC1_Flag_TypeDef flag);
+uint16_t ADC1_GetConversionValue(void);
+uint16_t ADC1_GetBufferValue(uint8_t buffer);
+void ADC1_SetHighThreshold(uint16_t threshold);
+void ADC1_SetLowThreshold(uint16_t threshold);
+void ADC1_AWDChannelConfig(ADC1_Channel_TypeDef channel, FunctionalState state);
+
+#endif
@@ -0,0 +1,10 @@
+/*
+Host stand-in for the CLK part of the ST peripheral library (tests/ only),
+the firmware runs on the reset clock and calls nothing from it.
+*/
+#ifndef __STM8S_CLK_H
+#define __STM8S_CLK_H
+
+#include "stm8s.h"
+
+#endif
@@ -0,0 +1,65 @@
+#include "stm8s.h"
+#include "HD44780.h"
+#include "profile.h"
+#include "match.h"
+#include "strtab.h"
+#include "text.h"
+
+static const uint8_t gGlyphs[] =
+{
+	0x04, 0x1F, 0x1F, 0x0E, 0x0E, 0x04, 0x1F, 0x04,	//diode, anode at the top
+	0x00, 0x0E, 0x11, 0x11, 0x11, 0x0A, 0x1B, 0x00,	//ohm
+	0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x1D, 0x10	//micro
+};
+
+static uint8_t gGlyphsLoaded;
+
+/*
+The texts have no offset table: skip id terminating zeros, then expand the
+pairs with a small stack instead of recursion, the last code on top.
+Skipping costs about 5 cycles per byte of StrData, less than 1 ms for the
+last text, the display needs LCD_STEP_MS per character anyway.
+*/
+void Say(uint8_t id)
+{
+	const uint8_t *p = StrData;
+	uint8_t stack[STR_DEPTH];
+	uint8_t sp, c;
+
+	while (id)
+	{
+		if (*p++ == 0)
+			id--;
+	}
+	while (*p)
+	{
+		stack[0] = *p++;
+		sp = 1;
+		while (sp)
+		{
+			c = stack[--sp];
+			if (c & 0x80)
+			{
+				stack[sp++] = StrPair[c & 0x7F][1];
+				stack[sp++] = StrPair[c & 0x7F][0];
+			}
+			else
+			{
+				SendData(c);
+			}
+		}
+	}
+}
+
+void LoadGlyphs(void)
+{
+	uint8_t i;
+
+	if (gGlyphsLoaded)
+		return;
+	SendCommand(0x40);	//CGRAM address 0
+	for (i = 0; i < sizeof(gGlyphs); i++)
+		SendData(gGlyphs[i]);
+	SendCommand(0x80);	//back to DDRAM
+	gGlyphsLoaded = 1;
+}
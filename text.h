@@ -0,0 +1,19 @@
+#ifndef __TEXT_H__
+#define __TEXT_H__
+
+/*
+LCD texts from the packed table strtab.c, generated by tools/mkstrings.py
+from strings.txt: Say(S_...) writes a text at the cursor.
+The glyphs live in CGRAM 0..2 and are shown with the aliases 8..10, code 0
+ends a text in the table.
+*/
+#define GLYPH_DIODE 8
+#define GLYPH_OHM 9
+#define GLYPH_MICRO 10
+
+void Say(uint8_t id);
+
+//writes the glyphs to CGRAM, once after power up (FinishLcd)
+void LoadGlyphs(void);
+
+#endif
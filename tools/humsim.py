@@ -0,0 +1,74 @@
+#!/usr/bin/env python
+"""
+Simulated hum source for the ADC readings of adc.c.
+
+usage: humsim.py [amplitude_lsb] [mains_hz]
+
+Adds a 50/60 Hz hum (with 3rd harmonic, random phase) to a constant voltage on
+an R_H node and models the ADC quantization. For every mode the tests see, it
+prints the largest error of the mean: the burst of ReadADC/ReadADCDiff and the
+TIM1 triggered ...Sync readings and ReadADCLong. The interval and the number of
+samples are taken from adc.h, so a change of MAINS_HZ, HUM_SAMPLES or
+LEAK_SAMPLES can be checked here. The mains frequency of the bench may differ
+from MAINS_HZ (e.g. 50.5) to see the effect of grid drift.
+"""
+import math
+import random
+import re
+import sys
+
+F_CPU = 2000000
+CONV_D12 = 14 * 12.0 / F_CPU	# one conversion, fADC = fCPU/12
+SCAN_D18 = 2 * 14 * 18.0 / F_CPU	# one scan of two channels, fADC = fCPU/18
+LEVEL = 511.3
+RUNS = 2000
+
+
+def defines(path):
+	d = {}
+	for line in open(path):
+		m = re.match(r"#define\s+(\w+)\s+(\d+)", line)
+		if m:
+			d[m.group(1)] = int(m.group(2))
+	return d
+
+
+def timer(hz, count):
+	# StartHum: ARR + 1 counts of fCPU per sample
+	return ((F_CPU + hz * count // 2) // (hz * count)) / float(F_CPU)
+
+
+def worst(amp, mains, count, interval):
+	err = 0.0
+	for i in range(RUNS):
+		ph = random.uniform(0, 2 * math.pi)
+		t0 = random.uniform(0, 1.0 / mains)
+		s = 0
+		for n in range(count):
+			t = t0 + n * interval
+			w = 2 * math.pi * mains * t + ph
+			v = LEVEL + amp * (math.sin(w) + 0.2 * math.sin(3 * w))
+			s += min(1023, max(0, int(v + 0.5)))
+		err = max(err, abs(s / float(count) - LEVEL))
+	return err
+
+
+def main():
+	amp = float(sys.argv[1]) if len(sys.argv) > 1 else 20.0
+	d = defines(sys.path[0] + "/../adc.h")
+	mains = float(sys.argv[2]) if len(sys.argv) > 2 else d["MAINS_HZ"]
+	hz = d["MAINS_HZ"]
+	modes = [
+		("ReadADC burst", d["ADC_SAMPLES"], CONV_D12),
+		("ReadADCDiff burst", d["PAIR_COUNT"], SCAN_D18),
+		("ReadADCDiffSync/ReadADCSync", d["HUM_SAMPLES"], timer(hz, d["HUM_SAMPLES"])),
+		("ReadADCLong", d["LEAK_SAMPLES"], timer(hz, d["LEAK_SAMPLES"])),
+	]
+	print("hum %.1f LSB at %.2f Hz, MAINS_HZ %d" % (amp, mains, hz))
+	for name, count, interval in modes:
+		print("%-28s %3d x %7.3f ms  worst error %5.2f LSB" % (name, count, interval * 1000, worst(amp, mains, count, interval)))
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+"""
+I-V curve of the curve mode (curve.h, CURVE 1).
+
+usage: ivplot.py capture.txt [plot.png]
+
+Reads the '#' frame sent by CurveSend over UART2, converts every point to
+the voltage across the junction and its current, and prints them sorted by
+current with a text plot (log current over voltage). With a second argument
+and matplotlib installed, the curve is also written as an image.
+R_L and R_H are taken from fixmath.h, as in the firmware.
+"""
+import math
+import re
+import sys
+
+VCC = 5.0
+DRIVE = {0: "firm", 1: "R_L", 2: "R_H"}
+
+
+def resistors(path):
+	d = {}
+	for line in open(path):
+		m = re.match(r"#define\s+(RL_OHM|RH_100)\s+(\d+)", line)
+		if m:
+			d[m.group(1)] = int(m.group(2))
+	return {1: float(d["RL_OHM"]), 2: d["RH_100"] * 100.0}
+
+
+def frame(path):
+	for line in open(path):
+		line = line.strip()
+		if line.startswith("#"):
+			data = bytes.fromhex(line[1:])
+			if sum(data[:-1]) & 0xFF != data[-1]:
+				sys.exit("checksum error")
+			return data
+	sys.exit("no frame")
+
+
+def points(data, res):
+	pins, n = data[0], data[1]
+	out = []
+	for i in range(n):
+		cfg, h, l, lo = data[2 + i * 4:6 + i * 4]
+		vh = ((h << 2) | (lo >> 2)) * VCC / 1023
+		vl = ((l << 2) | (lo & 3)) * VCC / 1023
+		src, snk = cfg & 3, (cfg >> 2) & 3
+		# the larger resistor has the larger drop, so the better resolution
+		if snk and (not src or res[snk] >= res[src]):
+			cur = vl / res[snk]
+		else:
+			cur = (VCC - vh) / res[src]
+		sign = -1 if cfg & 0x80 else 1
+		out.append((sign * (vh - vl), sign * cur, "%s/%s%s" % (DRIVE[src], DRIVE[snk], " rev" if sign < 0 else "")))
+	return pins >> 4, pins & 15, out
+
+
+def textplot(pts):
+	fwd = [p for p in pts if p[1] > 0]
+	if not fwd:
+		return
+	vmax = max(p[0] for p in fwd) or 1.0
+	print("\nlog10(I/A)  forward, U from 0 to %.2f V" % vmax)
+	for p in sorted(fwd, key=lambda p: -p[1]):
+		col = int(p[0] / vmax * 50)
+		print("%6.1f |%s*" % (math.log10(p[1]), " " * col))
+
+
+def main():
+	if len(sys.argv) < 2:
+		print(__doc__)
+		return 1
+	res = resistors(sys.path[0] + "/../fixmath.h")
+	a, k, pts = points(frame(sys.argv[1]), res)
+	print("junction A=TP%d K=TP%d" % (a + 1, k + 1))
+	print("%10s %12s  %s" % ("U [mV]", "I [uA]", "drive high/low"))
+	for u, i, name in sorted(pts, key=lambda p: p[1]):
+		print("%10.0f %12.2f  %s" % (u * 1000, i * 1e6, name))
+	textplot(pts)
+	if len(sys.argv) > 2:
+		try:
+			import matplotlib
+			matplotlib.use("Agg")
+			import matplotlib.pyplot as plt
+		except ImportError:
+			sys.exit("matplotlib not installed, no image")
+		fwd = sorted([p for p in pts if p[1] > 0], key=lambda p: p[0])
+		plt.semilogy([p[0] for p in fwd], [p[1] for p in fwd], "o-")
+		plt.xlabel("U [V]")
+		plt.ylabel("I [A]")
+		plt.title("TP%d -> TP%d" % (a + 1, k + 1))
+		plt.grid(True, which="both")
+		plt.savefig(sys.argv[2])
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main())
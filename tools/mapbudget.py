@@ -0,0 +1,97 @@
+#!/usr/bin/env python
+"""
+Flash/RAM/stack budget report for the Cosmic linker map (clnk -m).
+
+usage: mapbudget.py lcdtest.map
+
+Prints the size of every section per module and the worst case stack depth
+from the "Stack usage" part of the map, then compares the totals with the
+memory segments of lcdtest.lkf. Exit code 1 if a budget is exceeded, so the
+post-build step fails when a feature no longer fits.
+"""
+import re
+import sys
+
+# Code,Constants[0x8080-0xffff], Zero Page[0x0-0xff], Ram[0x100-0x5ff];
+# the stack grows down from 0x7ff (String.104.0 in lcdtest.stp)
+BUDGET = {
+	"flash": 0x7f80,
+	"zpage": 0x100,
+	"ram": 0x500,
+	"stack": 0x200,
+}
+
+FLASH = (".const", ".text", ".init")
+ZPAGE = (".bsct", ".ubsct", ".bit", ".share")
+RAM = (".data", ".bss")
+
+SECTION = re.compile(r"start\s+([0-9a-fA-F]+)\s+end\s+([0-9a-fA-F]+)\s+length\s+(\d+)\s+section\s+(\S+)")
+STACK = re.compile(r"^(\S+)\s+>?\s*(\d+)\s+\(\s*(\d+)\s*\)")
+
+
+def parse(lines):
+	modules = {}
+	stack = {}
+	part = None
+	module = None
+	for line in lines:
+		line = line.rstrip()
+		title = line.strip()
+		if title in ("Modules", "Stack usage", "Symbols", "Segments"):
+			part = title
+			module = None
+			continue
+		if not title or title.startswith("---"):
+			continue
+		if part == "Modules":
+			m = SECTION.search(line)
+			if m:
+				sizes = modules.setdefault(module, {})
+				sizes[m.group(4)] = sizes.get(m.group(4), 0) + int(m.group(3))
+			elif title.endswith(":"):
+				module = title[:-1].replace("\\", "/").split("/")[-1]
+		elif part == "Stack usage":
+			m = STACK.match(title)
+			if m:
+				stack[m.group(1)] = int(m.group(2))
+	return modules, stack
+
+
+def total(sizes, names):
+	return sum(sizes.get(n, 0) for n in names)
+
+
+def main():
+	if len(sys.argv) != 2:
+		sys.stderr.write("usage: mapbudget.py <map file>\n")
+		return 2
+	with open(sys.argv[1]) as f:
+		modules, stack = parse(f)
+
+	used = {"flash": 0, "zpage": 0, "ram": 0}
+	print("%-20s %7s %7s %7s" % ("module", "flash", "zpage", "ram"))
+	for name in sorted(modules):
+		sizes = modules[name]
+		row = (total(sizes, FLASH), total(sizes, ZPAGE), total(sizes, RAM))
+		used["flash"] += row[0]
+		used["zpage"] += row[1]
+		used["ram"] += row[2]
+		print("%-20s %7d %7d %7d" % ((name,) + row))
+
+	deepest = sorted(stack.items(), key=lambda s: -s[1])[:5]
+	for func, depth in deepest:
+		print("stack %-14s %7d" % (func, depth))
+	used["stack"] = deepest[0][1] if deepest else 0
+
+	fail = 0
+	for key in ("flash", "zpage", "ram", "stack"):
+		flag = ""
+		if used[key] > BUDGET[key]:
+			flag = "  OVER BUDGET"
+			fail = 1
+		print("%-6s %6d of %6d bytes (%3d%%)%s" % (key, used[key], BUDGET[key], used[key] * 100 // BUDGET[key], flag))
+	return fail
+
+
+if __name__ == "__main__":
+	sys.exit(main())
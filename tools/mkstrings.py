@@ -0,0 +1,297 @@
+#!/usr/bin/env python
+"""
+String table compiler for the LCD texts.
+
+usage: mkstrings.py [--check] [strings.txt]
+
+Reads strings.txt and writes strtab.h (the S_... ids) and strtab.c (the
+packed table) next to it. The texts are compressed with byte pair encoding:
+codes 0x80..0xff stand for a pair of codes from StrPair, which may again be
+pairs, Say() in text.c expands them on the fly straight into the display.
+The texts are stored in the order of their ids without an offset table,
+Say() counts the terminating zeros; a text that equals an earlier one gets
+the id of that one.
+
+--check only compares the generated files with the ones on disk, exit code 1
+if strings.txt was changed without running the compiler (pre-link step).
+
+The report at the end is the flash size of the table against the old
+const char arrays (one array with a terminating zero per text, plus the
+pointer tables for TimeoutKind and LedColor). Not counted: every call site
+loads a 1 byte id instead of a 2 byte address.
+"""
+import os
+import re
+import sys
+
+FIRST_PAIR = 0x80	# codes below are characters, from here on pairs
+MIN_USES = 3		# a pair costs 2 bytes in StrPair, each use saves 1 byte
+GLYPHS = {"d": 8, "o": 9, "u": 10}	# CGRAM 0..2, 8..15 are aliases that are no terminator
+HEADERS = ("stm8s.h", "profile.h", "match.h")	# define the section flags
+DECODER = 60		# bytes of code in Say(), estimated from the listing
+
+LINE = re.compile(r'^(\w+)((?:\s+"(?:[^"\\]|\\.)*")+)\s*$')
+TEXT = re.compile(r'"((?:[^"\\]|\\.)*)"')
+SECTION = re.compile(r"^\[(\w+)\]\s*$")
+
+
+def parse(path):
+	"""returns [(section, name, [texts])], section None for the common texts"""
+	entries = []
+	section = None
+	for number, line in enumerate(open(path), 1):
+		line = line.strip()
+		if not line or line.startswith("#"):
+			continue
+		m = SECTION.match(line)
+		if m:
+			section = m.group(1)
+			continue
+		m = LINE.match(line)
+		if not m:
+			sys.exit("%s:%d: syntax error" % (path, number))
+		texts = [unescape(t, path, number) for t in TEXT.findall(m.group(2))]
+		entries.append((section, m.group(1), texts))
+	return entries
+
+
+def unescape(text, path, number):
+	codes = []
+	i = 0
+	while i < len(text):
+		c = text[i]
+		if c == "\\":
+			i += 1
+			c = text[i]
+			if c in GLYPHS:
+				codes.append(GLYPHS[c])
+			elif c in "\\\"":
+				codes.append(ord(c))
+			else:
+				sys.exit("%s:%d: unknown escape \\%s" % (path, number, c))
+		elif 32 <= ord(c) < FIRST_PAIR:
+			codes.append(ord(c))
+		else:
+			sys.exit("%s:%d: character %r is not on the display" % (path, number, c))
+		i += 1
+	return tuple(codes)
+
+
+def pair_encode(texts):
+	"""byte pair encoding over all distinct texts, returns (encoded, pairs)"""
+	work = dict((t, list(t)) for t in texts)
+	pairs = []
+	while FIRST_PAIR + len(pairs) <= 0xff:
+		count = {}
+		for codes in work.values():
+			i = 0
+			while i < len(codes) - 1:
+				p = (codes[i], codes[i + 1])
+				count[p] = count.get(p, 0) + 1
+				# "aaa" holds only one "aa" that can be replaced
+				i += 2 if i + 2 < len(codes) and codes[i + 2] == codes[i] == codes[i + 1] else 1
+		if not count:
+			break
+		best = max(sorted(count), key=lambda p: count[p])
+		if count[best] < MIN_USES:
+			break
+		code = FIRST_PAIR + len(pairs)
+		pairs.append(best)
+		for codes in work.values():
+			i = 0
+			while i < len(codes) - 1:
+				if (codes[i], codes[i + 1]) == best:
+					codes[i:i + 2] = [code]
+				i += 1
+	return dict((t, tuple(c)) for t, c in work.items()), pairs
+
+
+def depth(code, pairs):
+	if code < FIRST_PAIR:
+		return 0
+	a, b = pairs[code - FIRST_PAIR]
+	return 1 + max(depth(a, pairs), depth(b, pairs))
+
+
+def show(codes):
+	s = ""
+	for c in codes:
+		if c in GLYPHS.values():
+			s += "\\" + [k for k, v in GLYPHS.items() if v == c][0]
+		else:
+			s += chr(c)
+	return s
+
+
+def expand(code, pairs):
+	if code < FIRST_PAIR:
+		return [code]
+	a, b = pairs[code - FIRST_PAIR]
+	return expand(a, pairs) + expand(b, pairs)
+
+
+def cchar(code):
+	if code >= FIRST_PAIR or code < 32:
+		return "0x%02X" % code
+	if chr(code) in "'\\":
+		return "'\\%s'" % chr(code)
+	return "'%s'" % chr(code)
+
+
+def build(entries):
+	"""returns (sections, ids, aliases, encoded, pairs)"""
+	# common texts first, then the sections in file order, so a section only
+	# moves the ids of the sections behind it
+	sections = [None]
+	for section, name, texts in entries:
+		if section not in sections:
+			sections.append(section)
+	ids = []		# (section, name, index, text), one text in StrData each
+	aliases = {}	# name: (name, index) of an equal text in the same or the common section
+	for s in sections:
+		for section, name, texts in entries:
+			if section != s:
+				continue
+			if len(texts) == 1:
+				for other in ids:
+					if other[3] == texts[0] and other[0] in (None, s):
+						aliases[name] = other[1:3]
+						break
+				if name in aliases:
+					continue
+			for i, t in enumerate(texts):
+				ids.append((s, name, i, t))
+	if len(ids) > 256:
+		sys.exit("more than 256 texts, the ids are uint8_t")
+	encoded, pairs = pair_encode(set(t for s, n, i, t in ids))
+	return sections, ids, aliases, encoded, pairs
+
+
+def label(name, i):
+	return "S_%s" % name if not i else "(S_%s + %d)" % (name, i)
+
+
+def header(entries, sections, ids, aliases, pairs, source):
+	out = []
+	out.append("/*")
+	out.append("Generated by tools/mkstrings.py from %s, do not edit." % source)
+	out.append("Ids of the LCD texts for Say(), see text.h.")
+	out.append("*/")
+	out.append("#ifndef __STRTAB_H__")
+	out.append("#define __STRTAB_H__")
+	prev = None
+	for s in sections:
+		out.append("")
+		if s is not None:
+			if prev is None:
+				out.append("#define STR_ID_%s %d" % (s, count(ids, None)))
+			else:
+				out.append("#define STR_ID_%s (STR_ID_%s + (%s ? %d : 0))" % (s, prev, prev, count(ids, prev)))
+			prev = s
+		own = [(name, i) for section, name, i, t in ids if section == s]
+		for n, (name, i) in enumerate(own):
+			if i:
+				continue
+			if s is None:
+				out.append("#define S_%s %d" % (name, n))
+			else:
+				out.append("#define S_%s (STR_ID_%s + %d)" % (name, s, n))
+		for section, name, texts in entries:
+			if section == s and name in aliases:
+				out.append("#define S_%s %s" % (name, label(*aliases[name])))
+	out.append("")
+	out.append("#define STR_PAIRS %d" % max(len(pairs), 1))
+	out.append("#define STR_DEPTH %d\t//nesting of the pairs, stack of Say()" % (max([depth(FIRST_PAIR + i, pairs) for i in range(len(pairs))] + [0]) + 1))
+	out.append("")
+	out.append("extern const uint8_t StrPair[STR_PAIRS][2];")
+	out.append("extern const uint8_t StrData[];")
+	out.append("")
+	out.append("#endif")
+	return "\n".join(out) + "\n"
+
+
+def count(ids, section):
+	return len([1 for s, n, i, t in ids if s == section])
+
+
+def source(sections, ids, encoded, pairs, path):
+	out = []
+	out.append("/*")
+	out.append("Generated by tools/mkstrings.py from %s, do not edit." % path)
+	out.append("Packed LCD texts: StrData holds the texts in the order of their ids, each")
+	out.append("ends with 0. Codes from 0x%02X are pairs from StrPair." % FIRST_PAIR)
+	out.append("*/")
+	for h in HEADERS:
+		out.append('#include "%s"' % h)
+	out.append('#include "strtab.h"')
+	out.append("")
+	out.append("const uint8_t StrPair[STR_PAIRS][2] = {")
+	for i, (a, b) in enumerate(pairs):
+		out.append("\t{%s, %s},\t//0x%02X \"%s\"" % (cchar(a), cchar(b), FIRST_PAIR + i, show(expand(FIRST_PAIR + i, pairs))))
+	if not pairs:
+		out.append("\t{0, 0}")
+	out.append("};")
+	out.append("")
+	out.append("const uint8_t StrData[] = {")
+	for s in sections:
+		if s is not None:
+			out.append("#if %s" % s)
+		for section, name, i, t in ids:
+			if section == s:
+				codes = encoded[t] + (0,)
+				out.append("\t%s,\t//%s \"%s\"" % (", ".join(cchar(c) for c in codes), label(name, i), show(t)))
+		if s is not None:
+			out.append("#endif")
+	out.append("};")
+	return "\n".join(out) + "\n"
+
+
+def report(entries, ids, encoded, pairs):
+	raw = 0
+	for section, name, texts in entries:
+		raw += sum(len(t) + 1 for t in texts)
+		if len(texts) > 1:
+			raw += 2 * len(texts)	# table of pointers
+	data = sum(len(encoded[t]) + 1 for s, n, i, t in ids)
+	pair = 2 * len(pairs)
+	print("strings: %d texts, %d bytes as const char arrays" % (sum(len(e[2]) for e in entries), raw))
+	print("strtab:  %d texts, %d data + %d pairs = %d bytes" % (len(ids), data, pair, data + pair))
+	print("Say():   about %d bytes of code" % DECODER)
+	print("saved:   %d bytes of flash with all sections, without the calls" % (raw - data - pair - DECODER))
+
+
+def main(args):
+	check = "--check" in args
+	args = [a for a in args if a != "--check"]
+	path = args[0] if args else os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "strings.txt")
+	entries = parse(path)
+	sections, ids, aliases, encoded, pairs = build(entries)
+	name = os.path.basename(path)
+	files = {
+		"strtab.h": header(entries, sections, ids, aliases, pairs, name),
+		"strtab.c": source(sections, ids, encoded, pairs, name),
+	}
+	folder = os.path.dirname(os.path.abspath(path))
+	stale = []
+	for f, text in sorted(files.items()):
+		target = os.path.join(folder, f)
+		old = open(target).read() if os.path.exists(target) else None
+		if old is not None:
+			old = old.replace("\r\n", "\n")
+		if old == text:
+			continue
+		if check:
+			stale.append(f)
+		else:
+			open(target, "w").write(text)
+	if check:
+		if stale:
+			print("%s out of date, run tools/mkstrings.py" % ", ".join(stale))
+			return 1
+		return 0
+	report(entries, ids, encoded, pairs)
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+"""
+Replay of a flight recorder dump (trace.h, TRACE 1).
+
+usage: tracereplay.py dump.txt [step]
+
+Reads the hex lines sent by TraceDump over UART2 and lists every ADC result
+in the order CheckPins and the characterizations took them, with the time,
+the probe pin states and the voltage. With step (0..9) only that step of
+TestPart is listed. The listing follows the decision path of main.c: the
+thresholds there (e.g. adcv[0] < 200) can be checked line by line.
+The count of RiseTimeADC and the sums of SweepADC are records of their own
+(trace.h), their voltage column has no meaning. tests/replay.c runs the
+identification code itself on a dump.
+
+Pin states: + / 0 driven high / low, L+ L- over R_L, H+ H- over R_H, z open.
+"""
+import sys
+
+STEPS = {
+	0: "CheckPins High=TP1 Low=TP2 Tri=TP3",
+	1: "CheckPins High=TP1 Low=TP3 Tri=TP2",
+	2: "CheckPins High=TP2 Low=TP1 Tri=TP3",
+	3: "CheckPins High=TP2 Low=TP3 Tri=TP1",
+	4: "CheckPins High=TP3 Low=TP2 Tri=TP1",
+	5: "CheckPins High=TP3 Low=TP1 Tri=TP2",
+	6: "ReadDepletionFET",
+	7: "ReadThyristor",
+	9: "ReadRecovery",
+}
+
+MARK = 3
+SOCKET = 0x80
+TICK_MS = 1.024
+
+
+def read_dump(lines):
+	data = bytearray()
+	length = full = None
+	for line in lines:
+		line = line.strip()
+		if line.startswith(":"):
+			data += bytearray.fromhex(line[1:])
+		elif line.startswith("END"):
+			f = line.split()
+			length, full = int(f[1], 16), int(f[2], 16)
+	if length is None:
+		raise ValueError("no END line, dump incomplete")
+	if length != len(data):
+		raise ValueError("length %d, %d bytes received" % (length, len(data)))
+	return data, full
+
+
+def pins(p):
+	b_ddr, b_odr = p[0] & 7, (p[0] >> 3) & 7
+	out = []
+	for tp in range(3):
+		rl, rh = 1 << (tp * 2 + 1), 2 << (tp * 2 + 1)
+		if b_ddr & (1 << tp):
+			s = "+" if b_odr & (1 << tp) else "0"
+		elif p[1] & rl:
+			s = "L+" if p[2] & rl else "L-"
+		elif p[1] & rh:
+			s = "H+" if p[2] & rh else "H-"
+		else:
+			s = "z"
+		out.append("TP%d:%-2s" % (tp + 1, s))
+	return " ".join(out)
+
+
+def decode(data):
+	"""yields (ticks, kind, ...) in recording order"""
+	i = 0
+	time = 0
+	last = [None, None, None]
+	port = None
+	while i < len(data):
+		h = data[i]
+		i += 1
+		ch = h & 3
+		time += h >> 4
+		if ch == MARK:
+			ident = data[i]
+			time = (data[i + 1] << 8) | data[i + 2]
+			i += 3
+			last = [None, None, None]
+			yield (time, "mark", ident)
+			continue
+		if h & 4:
+			port = data[i:i + 3]
+			i += 3
+		if h & 8:
+			d = data[i]
+			i += 1
+			value = last[ch] + (d - 256 if d > 127 else d)
+		else:
+			value = (data[i] << 8) | data[i + 1]
+			i += 2
+		last[ch] = value
+		yield (time, "adc", ch, value, port)
+
+
+def main():
+	if len(sys.argv) not in (2, 3):
+		sys.stderr.write("usage: tracereplay.py <dump> [step]\n")
+		return 2
+	only = int(sys.argv[2]) if len(sys.argv) == 3 else None
+	with open(sys.argv[1]) as f:
+		data, full = read_dump(f)
+
+	step = None
+	for rec in decode(data):
+		ms = rec[0] * TICK_MS
+		if rec[1] == "mark":
+			if rec[2] & SOCKET:
+				print("==== socket %d" % (rec[2] - SOCKET + 1))
+				step = None
+				continue
+			step = rec[2]
+			if only is None or only == step:
+				print("---- %8.1f ms  step %d: %s" % (ms, step, STEPS.get(step, "?")))
+			continue
+		if only is not None and only != step:
+			continue
+		ch, value, port = rec[2], rec[3], rec[4]
+		mv = "%5d mV" % (value * 5000 // 1023) if value <= 1023 else "%5d/16" % value
+		print("%8.1f ms  %s  TP%d %5d %s" % (ms, pins(port), ch + 1, value, mv))
+	if full:
+		print("**** trace buffer full, the rest of the test is missing")
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main())
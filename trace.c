@@ -0,0 +1,159 @@
+#include "stm8s.h"
+#include "trace.h"
+#include "watchdog.h"
+#include "serial.h"
+
+#if TRACE
+
+static struct
+{
+	uint8_t buf[TRACE_SIZE];
+	uint16_t len;
+	uint8_t full;
+	uint16_t time;			//ticks of the last record
+	uint16_t last[3];		//last value of each channel
+	uint8_t port[3];		//last port state
+} gTrace;
+
+static void Put(uint8_t b)
+{
+	gTrace.buf[gTrace.len++] = b;
+}
+
+//header with the ticks since the last record; 0 if there is no room for max bytes
+static uint8_t Header(uint8_t max)
+{
+	uint16_t now, dt;
+
+	if (gTrace.full || (gTrace.len + max > TRACE_SIZE))
+	{
+		gTrace.full = 1;
+		return 0;
+	}
+
+	now = Ticks();
+	dt = now - gTrace.time;
+	gTrace.time = now;
+
+	return (uint8_t)(((dt > 15) ? 15 : dt) << 4);
+}
+
+//empties the buffer, called once before the sockets are tested
+void TraceStart(void)
+{
+	gTrace.len = 0;
+	gTrace.full = 0;
+}
+
+/*
+Mark with absolute time, all deltas after it refer to absolute values again,
+so each mark is a starting point for the replay.
+*/
+void TraceMark(uint8_t id)
+{
+	uint8_t h = Header(4);
+
+	if (gTrace.full)
+	{
+		return;
+	}
+
+	Put(h | TRACE_MARK);
+	Put(id);
+	Put((uint8_t)(gTrace.time >> 8));
+	Put((uint8_t)gTrace.time);
+
+	gTrace.last[0] = gTrace.last[1] = gTrace.last[2] = 0xFFFF;	//no reference: next values absolute
+	gTrace.port[0] = 0xFF;	//port state follows with the next value
+}
+
+/*
+One ADC result with the pin state it was measured with.
+About 30 us, only after the conversions, so the measurement timing is kept.
+*/
+void TraceADC(uint8_t ch, uint16_t value)
+{
+	uint8_t h = Header(6);
+	uint8_t p0, p1, p2;
+	int16_t d;
+
+	if (gTrace.full)
+	{
+		return;
+	}
+
+	p0 = (uint8_t)((GPIOB->DDR & 7) | ((GPIOB->ODR & 7) << 3));
+	p1 = GPIOC->DDR;
+	p2 = GPIOC->ODR;
+
+	h |= ch;
+	if ((p0 != gTrace.port[0]) || (p1 != gTrace.port[1]) || (p2 != gTrace.port[2]))
+	{
+		h |= 4;
+	}
+	d = (int16_t)(value - gTrace.last[ch]);
+	if ((gTrace.last[ch] != 0xFFFF) && (d >= -128) && (d <= 127))
+	{
+		h |= 8;
+	}
+
+	Put(h);
+	if (h & 4)
+	{
+		Put(p0);
+		Put(p1);
+		Put(p2);
+		gTrace.port[0] = p0;
+		gTrace.port[1] = p1;
+		gTrace.port[2] = p2;
+	}
+	if (h & 8)
+	{
+		Put((uint8_t)d);
+	}
+	else
+	{
+		Put((uint8_t)(value >> 8));
+		Put((uint8_t)value);
+	}
+	gTrace.last[ch] = value;
+}
+
+/*
+Sends the buffer as hex text, 32 bytes per line, then "END <length> <full>".
+*/
+void TraceDump(void)
+{
+	uint16_t i;
+
+	SerialOpen(TRACE_BAUD);
+
+	for (i = 0; i < gTrace.len; i++)
+	{
+		if ((i & 31) == 0)
+		{
+			WdtReset();		//about 70 ms per line
+			SerialSend(':');
+		}
+		SerialHex(gTrace.buf[i]);
+		if (((i & 31) == 31) || (i == gTrace.len - 1))
+		{
+			SerialSend('\r');
+			SerialSend('\n');
+		}
+	}
+	SerialSend('E');
+	SerialSend('N');
+	SerialSend('D');
+	SerialSend(' ');
+	SerialHex((uint8_t)(gTrace.len >> 8));
+	SerialHex((uint8_t)gTrace.len);
+	SerialSend(' ');
+	SerialHex(gTrace.full);
+	SerialSend('\r');
+	SerialSend('\n');
+
+	SerialClose();
+}
+
+#endif
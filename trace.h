@@ -0,0 +1,57 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+/*
+Flight recorder: every ADC result of the measurement is stored together with
+the probe pin states, so a misidentification can be replayed offline
+(tools/tracereplay.py). Off by default, it costs TRACE_SIZE bytes of RAM.
+
+Record format, delta-encoded:
+  header  bit 0-1  channel (TP1..TP3), 3 = mark
+          bit 2    P: port state changed, 3 bytes follow:
+                   GPIOB DDR | ODR << 3 (TP1..TP3), GPIOC DDR, GPIOC ODR
+          bit 3    D: value is a signed byte, the difference to the last value
+                   of this channel; else 2 bytes absolute (high byte first)
+          bit 4-7  ticks (1.024 ms) since the last record, 15 = 15 or more
+  mark    header with channel 3, id byte, absolute ticks (2 bytes);
+          id = step of MeasurePart, 0x80 + socket at each selection of ScanSockets
+The buffer starts with a mark, so every delta has its reference. When it is
+full, recording stops and the overflow flag of the dump is set.
+
+Records of the readings of adc.h, each with the pin state it was called with:
+  one value            ReadADC .. ReadADCSync, WaitADC, WatchADC
+  TP1, TP2, TP3        ReadADCScan
+  tpA, tpB             ReadADCPair(Fine), ReadADCDiff(Sync) (tpHigh, tpLow)
+  value, count         RiseTimeADC: last conversion, then the result
+  SWEEP_POINTS sums    SweepADC, after the capture (GPIOC back at Fwd)
+So the dump holds every result the decisions of main.c depend on, and a host
+build can replay them (tests/replay.c).
+*/
+#ifndef TRACE
+#define TRACE 0				//1 = flight recorder in the firmware
+#endif
+
+#ifndef TRACE_SIZE
+#define TRACE_SIZE 512		//bytes, about 200 ADC results
+#endif
+#define TRACE_MARK 3		//channel of a mark record
+#define TRACE_SOCKET 0x80	//mark id: start of a socket
+
+#define TRACE_BAUD 9600		//UART2 TX on PD5
+
+#if TRACE
+void TraceStart(void);
+
+void TraceMark(uint8_t id);
+
+void TraceADC(uint8_t ch, uint16_t value);
+
+void TraceDump(void);
+#else
+#define TraceStart()
+#define TraceMark(id)
+#define TraceADC(ch, value)
+#define TraceDump()
+#endif
+
+#endif
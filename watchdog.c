@@ -0,0 +1,59 @@
+#include "stm8s.h"
+#include "watchdog.h"
+
+static uint16_t gDeadline;
+
+/*
+IWDG with the longest timeout: LSI/2 = 64 kHz, prescaler 256, reload 255 => 1.02 s.
+TIM2 runs free as millisecond time base for the deadlines, no interrupt is used.
+*/
+void InitWatchdog(void)
+{
+#ifdef WDT_enabled
+	IWDG->KR = IWDG_KEY_ENABLE;
+	IWDG->KR = IWDG_KEY_ACCESS;
+	IWDG->PR = 6;		//divider 256
+	IWDG->RLR = 0xFF;
+	IWDG->KR = IWDG_KEY_REFRESH;
+#endif
+
+	TIM2->PSCR = TICK_SHIFT;
+	TIM2->ARRH = 0xFF;
+	TIM2->ARRL = 0xFF;
+	TIM2->EGR = TIM2_EGR_UG;	//load the prescaler
+	TIM2->CR1 = TIM2_CR1_CEN;
+}
+
+//was the last reset caused by the IWDG? The flag is cleared.
+uint8_t WatchdogReset(void)
+{
+	if (RST->SR & RST_SR_IWDGF)
+	{
+		RST->SR = RST_SR_IWDGF;	//cleared by writing 1
+		return 1;
+	}
+
+	return 0;
+}
+
+//ticks of the free running time base since InitWatchdog, 1.024 ms each
+uint16_t Ticks(void)
+{
+	uint16_t now;
+
+	now = (uint16_t)TIM2->CNTRH << 8;	//reading CNTRH latches CNTRL
+	now |= TIM2->CNTRL;
+
+	return now;
+}
+
+//DeadlineExpired reports when ms have passed from now on
+void StartDeadline(uint16_t ms)
+{
+	gDeadline = Ticks() + MsToTicks(ms);
+}
+
+uint8_t DeadlineExpired(void)
+{
+	return ((int16_t)(Ticks() - gDeadline) >= 0);
+}
@@ -0,0 +1,52 @@
+#ifndef __WATCHDOG_H__
+#define __WATCHDOG_H__
+
+/*If the define "WDT_enabled" removed, the watchdog on startup
+  no longer active. This is useful for testing and debugging purposes.
+  For normal use of the tester, the watchdog should also be activated without fail!
+*/
+#define WDT_enabled
+
+/*
+Time limits of one test run.
+Every wait in the measurement path is bounded: delays are fixed, WaitADC stops
+after its MaxCount, the EOC waits of adc.c after EOC_TIMEOUT polls. TestPart
+checks the deadline after every step (one pin permutation or one
+characterization), so a run ends at the latest TEST_DEADLINE plus the longest
+step. The longest step is a CheckPins with all branches, about 0.45 s
+(delays 225 ms, DischargeAll at most 12 ms, DischargePin 2 ms, WaitADC 40 ms,
+the gate threshold of a MOSFET at most 8 x 6 ms, ADC reads about 100 ms, of
+these 4 mains synchronous readings of 20 ms each).
+Guaranteed identification time per socket: 1.5 s + 0.45 s = 1.95 s.
+A charged capacitor is discharged before the deadline starts (DischargeAll,
+up to 2 s with refreshes of the IWDG).
+If a step hangs nevertheless, the IWDG resets the controller after 1.02 s
+without refresh; TestPart and the display loop refresh it far more often.
+*/
+#define TEST_DEADLINE 1500	//ms per socket
+
+#define TICK_SHIFT 11	//TIM2 prescaler 2^11: one tick is 1.024 ms at 2 MHz
+#define TicksToMs(t) ((uint16_t)(((uint32_t)(t) << TICK_SHIFT) / (F_CPU / 1000)))
+#define MsToTicks(ms) ((uint16_t)(((uint32_t)(ms) * (F_CPU >> TICK_SHIFT)) / 1000))
+
+#define IWDG_KEY_ENABLE 0xCC
+#define IWDG_KEY_REFRESH 0xAA
+#define IWDG_KEY_ACCESS 0x55
+
+#ifdef WDT_enabled
+#define WdtReset() (IWDG->KR = IWDG_KEY_REFRESH)
+#else
+#define WdtReset()
+#endif
+
+void InitWatchdog(void);
+
+uint8_t WatchdogReset(void);
+
+uint16_t Ticks(void);
+
+void StartDeadline(uint16_t ms);
+
+uint8_t DeadlineExpired(void);
+
+#endif